@@ -0,0 +1,83 @@
+// Batch evaluation against running the bytecode once per row: the same random pipeline graph
+// over the same generated rows, timed both ways, with rows per second. Every output of every
+// row must match the per-row result to the bit; exits with 1 if one does not.
+// Usage: bench_batch [rows] [nodes]
+#include <stdio.h>
+#include <stdlib.h>
+#include "graph.h"
+#include "eval.h"
+#include "bytecode.h"
+#include "batch_eval.h"
+#include "bench_util.h"
+#include "bench_dataflow.h"
+
+#define INPUTS 16
+#define WINDOW 32 // inputs come from at most this many nodes back
+
+// Row r's value of input p; small integers, with zeros, so the compares and selects branch.
+static float input_value(int r, int p) {
+    return (float)((r * 7 + p * 13 + r / 5) % 21) - 10.0f;
+}
+
+int main(int argc, char* argv[]) {
+    int rowCount = argc > 1 ? atoi(argv[1]) : 1 << 20;
+    int nodeCount = argc > 2 ? atoi(argv[2]) : 512;
+    if (nodeCount < 2 * INPUTS) nodeCount = 2 * INPUTS;
+    srand(1);
+
+    Graph graph;
+    Evaluator eval;
+    if (!graph_init(&graph) || !eval_init(&eval)) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    build_dataflow(&graph, nodeCount, INPUTS, WINDOW, false);
+    int parameters[INPUTS];
+    for (int p = 0; p < INPUTS; p++) parameters[p] = p;
+    BytecodeProgram program;
+    if (!bytecode_compile(&program, &eval, &graph, parameters, INPUTS, NULL, 0)) return 1;
+
+    Arena arena;
+    BatchEvaluator batch;
+    float* expected = malloc((size_t)BATCH_SIZE * program.outputCount * sizeof(float));
+    if (!expected || !arena_init(&arena, batch_arena_bytes(&program)) || !batch_init(&batch, &program, &arena)) {
+        printf("Out of memory\n");
+        return 1;
+    }
+
+    double rowSeconds = 0.0, batchSeconds = 0.0;
+    bool same = true;
+    for (int first = 0; first < rowCount; first += BATCH_SIZE) {
+        int rows = rowCount - first < BATCH_SIZE ? rowCount - first : BATCH_SIZE;
+        double start = now_seconds();
+        for (int r = 0; r < rows; r++) {
+            for (int p = 0; p < INPUTS; p++) bytecode_set_parameter(&program, p, input_value(first + r, p));
+            bytecode_run(&program);
+            for (int o = 0; o < program.outputCount; o++) expected[(size_t)o * BATCH_SIZE + r] = bytecode_output(&program, o);
+        }
+        rowSeconds += now_seconds() - start;
+
+        start = now_seconds();
+        for (int p = 0; p < INPUTS; p++) {
+            float* column = batch_input(&batch, p);
+            for (int r = 0; r < rows; r++) column[r] = input_value(first + r, p);
+        }
+        batch_run(&batch, rows);
+        batchSeconds += now_seconds() - start;
+        for (int o = 0; o < program.outputCount && same; o++) {
+            const float* column = batch_output(&batch, o);
+            for (int r = 0; r < rows && same; r++) same = same_bits(column[r], expected[(size_t)o * BATCH_SIZE + r]);
+        }
+    }
+    printf("rows=%d nodes=%d instructions=%d registers=%d outputs=%d isa=%s arena_kb=%zu per_row_ms=%.1f "
+           "batch_ms=%.1f rows_per_sec=%.3g speedup=%.1f match=%s\n",
+           rowCount, nodeCount, program.codeLength, program.registerCount, program.outputCount, batch_isa(),
+           arena.used / 1024, rowSeconds * 1e3, batchSeconds * 1e3, rowCount / batchSeconds, rowSeconds / batchSeconds,
+           same ? "ok" : "MISMATCH");
+    arena_destroy(&arena);
+    free(expected);
+    bytecode_destroy(&program);
+    eval_destroy(&eval);
+    graph_destroy(&graph);
+    return same ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+// Bytecode against interpreting the graph: a parameter sweep over a random typed DAG, timed
+// three ways per run. "naive" walks each node's input connections and switches on its type,
+// "plan" runs the evaluator's compiled steps, "bytecode" runs the lowered program. Every
+// late root reaches nearly the whole graph, so even a few parameters leave little to fold
+// and the comparison is mostly dispatch against dispatch; the folded and dead counts show
+// what compiling removed. Every run's outputs must match the plan's to the bit; exits with
+// 1 if one does not.
+// Usage: bench_bytecode [nodes] [runs]
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "graph.h"
+#include "eval.h"
+#include "bytecode.h"
+#include "bench_util.h"
+#include "bench_dataflow.h"
+
+#define ROOTS 1024 // Variables and Toggles at the start, the graph's inputs
+#define WINDOW 256 // inputs come from at most this many nodes back
+
+// Per-node interpretation: find the inputs through the connection lists on every run.
+static void naive_run(const Evaluator* eval, const Graph* graph, float* values) {
+    for (int k = 0; k < eval->stepCount; k++) {
+        int node = eval->steps[k].node;
+        const Node2D* n = &graph->nodes[node];
+        float in[NODE_MAX_INPUTS] = {0.0f, 0.0f, 0.0f};
+        bool connected = false;
+        for (int c = graph_first_in(graph, node); c != -1; c = graph_next_in(graph, c)) {
+            const Connection* connection = &graph->connections[c];
+            if (!eval_types_match(&graph->nodes[connection->fromNode], n, connection->toSlot)) continue;
+            in[connection->toSlot] = values[connection->fromNode];
+            connected = true;
+        }
+        float a = in[0], b = in[1];
+        switch (n->type) {
+        case NODE_VARIABLE: values[node] = connected ? a : n->value; break;
+        case NODE_TOGGLE: values[node] = n->value != 0.0f; break;
+        case NODE_ADD: values[node] = a + b; break;
+        case NODE_SUBTRACT: values[node] = a - b; break;
+        case NODE_MULTIPLY: values[node] = a * b; break;
+        case NODE_DIVIDE: values[node] = a / b; break;
+        case NODE_MIN: values[node] = eval_min(a, b); break;
+        case NODE_MAX: values[node] = eval_max(a, b); break;
+        case NODE_LESS: values[node] = a < b; break;
+        case NODE_GREATER: values[node] = a > b; break;
+        case NODE_EQUAL: values[node] = a == b; break;
+        case NODE_AND: values[node] = a != 0.0f && b != 0.0f; break;
+        case NODE_OR: values[node] = a != 0.0f || b != 0.0f; break;
+        case NODE_NOT: values[node] = a == 0.0f; break;
+        case NODE_SELECT: values[node] = a != 0.0f ? b : in[2]; break;
+        default: break;
+        }
+    }
+}
+
+// Sweeps parameterCount Variables through runs values each and times every evaluator.
+static bool sweep(Graph* graph, Evaluator* eval, int parameterCount, int runs) {
+    int* parameters = malloc((size_t)parameterCount * sizeof(int));
+    float* naiveValues = calloc((size_t)graph->nodeCount, sizeof(float));
+    if (!parameters || !naiveValues) return false;
+    // Counting down from the last root: only the last WINDOW roots feed the rest of the graph.
+    for (int i = 0; i < parameterCount; i++) parameters[i] = ROOTS - 1 - (i + i / 3); // skips the Toggles
+
+    BytecodeProgram program;
+    double start = now_seconds();
+    if (!bytecode_compile(&program, eval, graph, parameters, parameterCount, NULL, 0)) return false;
+    double compileSeconds = now_seconds() - start;
+
+    double naiveSeconds = 0.0, planSeconds = 0.0, bytecodeSeconds = 0.0;
+    bool same = true;
+    for (int run = 0; run < runs; run++) {
+        for (int i = 0; i < parameterCount; i++) {
+            float value = (float)((run * 7 + i * 13) % 101) - 50.0f;
+            graph->nodes[parameters[i]].value = value;
+            bytecode_set_parameter(&program, i, value);
+        }
+        start = now_seconds();
+        naive_run(eval, graph, naiveValues);
+        naiveSeconds += now_seconds() - start;
+        start = now_seconds();
+        eval_run(eval, graph);
+        planSeconds += now_seconds() - start;
+        start = now_seconds();
+        bytecode_run(&program);
+        bytecodeSeconds += now_seconds() - start;
+        for (int o = 0; o < program.outputCount && same; o++) {
+            int node = program.outputNodes[o];
+            same = same_bits(bytecode_output(&program, o), eval_value(eval, node)) &&
+                   same_bits(naiveValues[node], eval_value(eval, node));
+        }
+    }
+    printf("parameters=%d nodes=%d instructions=%d folded=%d dead=%d registers=%d outputs=%d compile_ms=%.2f "
+           "naive_ms=%.2f plan_ms=%.2f bytecode_ms=%.3f speedup_vs_naive=%.1f speedup_vs_plan=%.1f match=%s\n",
+           parameterCount, eval->stepCount, program.codeLength, program.foldedCount, program.deadCount,
+           program.registerCount, program.outputCount, compileSeconds * 1e3, naiveSeconds * 1e3 / runs,
+           planSeconds * 1e3 / runs, bytecodeSeconds * 1e3 / runs, naiveSeconds / bytecodeSeconds,
+           planSeconds / bytecodeSeconds, same ? "ok" : "MISMATCH");
+    bytecode_destroy(&program);
+    free(naiveValues);
+    free(parameters);
+    return same;
+}
+
+int main(int argc, char* argv[]) {
+    int nodeCount = argc > 1 ? atoi(argv[1]) : 1000000;
+    int runs = argc > 2 ? atoi(argv[2]) : 20;
+    if (nodeCount < 2 * ROOTS) nodeCount = 2 * ROOTS;
+    srand(1);
+
+    Graph graph;
+    Evaluator eval;
+    if (!graph_init(&graph) || !eval_init(&eval)) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    build_dataflow(&graph, nodeCount, ROOTS, WINDOW, true);
+    if (!eval_compile(&eval, &graph)) return 1;
+
+    bool same = sweep(&graph, &eval, 4, runs);
+    same = sweep(&graph, &eval, 64, runs) && same;
+    same = sweep(&graph, &eval, ROOTS / 4 * 3, runs) && same; // every Variable
+    eval_destroy(&eval);
+    graph_destroy(&graph);
+    return same ? 0 : 1;
+}
@@ -0,0 +1,38 @@
+#ifndef BENCH_DATAFLOW_H
+#define BENCH_DATAFLOW_H
+
+// The random typed DAG the evaluator benchmarks run on.
+#include <stdbool.h>
+#include <stdlib.h>
+#include "graph.h"
+#include "eval.h"
+
+// roots Variables come first and are the graph's inputs; with randomRoots every fourth is a
+// Toggle and all get random values, otherwise they stay Variables at 0. Every later node has
+// a random type and reads nodes at most window back, so the graph is acyclic and deep.
+// Inputs are only connected to outputs of their type; some stay open.
+static inline void build_dataflow(Graph* graph, int nodeCount, int roots, int window, bool randomRoots) {
+    graph_reserve(graph, nodeCount, nodeCount * 2);
+    for (int i = 0; i < nodeCount; i++) {
+        int n = graph_add_node(graph, 0.0f, 0.0f, "");
+        Node2D* node = &graph->nodes[n];
+        if (i < roots) {
+            if (!randomRoots) continue;
+            node->type = i % 4 ? NODE_VARIABLE : NODE_TOGGLE;
+            node->value = node->type == NODE_TOGGLE ? (float)(i / 4 % 2) : (float)(rand() % 100);
+            continue;
+        }
+        node->type = (NodeType)(NODE_ADD + rand() % (NODE_TYPE_COUNT - NODE_ADD));
+        for (int s = 0; s < node_input_count(node->type); s++) {
+            for (int attempt = 0; attempt < 16; attempt++) {
+                int from = i - 1 - rand() % (i < window ? i : window);
+                if (eval_types_match(&graph->nodes[from], node, s)) {
+                    graph_add_connection(graph, from, n, s);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,404 @@
+// Frame cost of the editor under scripted interaction, headless.
+// Builds a synthetic graph, then runs pan, zoom, overview (panning the whole graph at
+// ZOOM_MIN, where nodes are drawn as cluster impostors), drag, autosave (the drag again with
+// a background save after every frame that changed the graph), connect, undo (a batch delete
+// of up to 10k nodes, then undone and redone on alternate frames) and delete phases against
+// the editor core, rendering every frame into an offscreen framebuffer of a hidden window.
+// Prints one JSON object with per-phase frame times, draw calls, upload bytes, heap calls,
+// vertex stream fence waits, autosaves and undo history size. The view-only phases (pan,
+// zoom, overview) repeat their motion, so by their second half (with the default 300
+// frames) every buffer has grown to size: a heap call there fails the run with exit code 1.
+// Usage: bench_editor [--nodes N] [--degree D] [--frames F] [--stream persistent|unsynchronized|orphan]
+// --stream caps how vertex data is uploaded, to compare the paths on one machine.
+// Without a GPU, run with LIBGL_ALWAYS_SOFTWARE=1 (Mesa llvmpipe) and, if there is no
+// display, SDL_VIDEODRIVER=offscreen or under xvfb-run.
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <glad/gl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "editor.h"
+#include "gl_util.h"
+#include "input.h"
+#include "mem.h"
+
+typedef enum {
+    PHASE_PAN,
+    PHASE_ZOOM,
+    PHASE_OVERVIEW,
+    PHASE_DRAG,
+    PHASE_AUTOSAVE,
+    PHASE_CONNECT,
+    PHASE_UNDO,
+    PHASE_DELETE,
+    PHASE_COUNT
+} Phase;
+
+// A 1000 Hz mouse delivers about this many motion reports per frame at 120 Hz.
+#define MOTION_REPORTS_PER_FRAME 8
+
+static const char* phaseNames[PHASE_COUNT] = {"pan", "zoom", "overview", "drag", "autosave", "connect", "undo", "delete"};
+static const bool steadyPhases[PHASE_COUNT] = {[PHASE_PAN] = true, [PHASE_ZOOM] = true, [PHASE_OVERVIEW] = true};
+
+typedef struct {
+    int hub;          // node with the most connections, dragged in the drag phase
+    int connectFrom;  // scan cursors so each connect/delete frame picks a fresh node
+    int connectTo;
+    int deleteNext;
+    bool batchDeleted; // the undo phase's batch delete is currently applied
+} Script;
+
+// Scripted events go through the same per-frame coalescing as live input.
+static InputFrame scriptInput;
+static float scriptMouseX, scriptMouseY;
+
+#define BENCH_AUTOSAVE_PATH "bench_autosave.n2d"
+#define BENCH_UNDO_BATCH 10000
+
+static double now_seconds(void) {
+    return (double)SDL_GetPerformanceCounter() / (double)SDL_GetPerformanceFrequency();
+}
+
+static void send_button(Uint32 type, Uint8 button, float x, float y) {
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = type;
+    event.button.button = button;
+    event.button.down = type == SDL_EVENT_MOUSE_BUTTON_DOWN;
+    event.button.x = x;
+    event.button.y = y;
+    input_frame_push(&scriptInput, &event);
+}
+
+static void send_motion(float x, float y) {
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = SDL_EVENT_MOUSE_MOTION;
+    event.motion.xrel = x - scriptMouseX;
+    event.motion.yrel = y - scriptMouseY;
+    event.motion.x = x;
+    event.motion.y = y;
+    scriptMouseX = x;
+    scriptMouseY = y;
+    input_frame_push(&scriptInput, &event);
+}
+
+static void send_key(SDL_Keycode key, SDL_Keymod mod) {
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = SDL_EVENT_KEY_DOWN;
+    event.key.key = key;
+    event.key.mod = mod;
+    event.key.down = true;
+    input_frame_push(&scriptInput, &event);
+}
+
+static void send_wheel(float y) {
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = SDL_EVENT_MOUSE_WHEEL;
+    event.wheel.y = y;
+    input_frame_push(&scriptInput, &event);
+}
+
+static float screen_x(const Editor* editor, float worldX) {
+    return worldX * editor->camera.scale - editor->camera.x;
+}
+
+static float screen_y(const Editor* editor, float worldY) {
+    return worldY * editor->camera.scale - editor->camera.y;
+}
+
+// Nodes on a lattice. The hub feeds the inputs of up to 256 nodes; every other node tries
+// degree connections to nodes a little further along, skipping inputs already in use.
+static void build_graph(Editor* editor, Script* script, int nodeCount, int degree) {
+    int side = 1;
+    while (side * side < nodeCount) side++;
+    graph_reserve(&editor->graph, nodeCount, nodeCount);
+    for (int i = 0; i < nodeCount; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "Node %d", i);
+        editor_add_node(editor, NODE_VARIABLE, (i % side) * 150.0f, (i / side) * 150.0f, name);
+    }
+    script->hub = 0;
+    for (int i = 1; i < nodeCount && i <= 256; i++) editor_connect(editor, 0, i, 0);
+    for (int i = 1; i < nodeCount; i++) {
+        for (int d = 0; d < degree; d++) {
+            int to = i + 1 + rand() % 8;
+            if (to < nodeCount) editor_connect(editor, i, to, 0);
+        }
+    }
+}
+
+static void center_on(Editor* editor, int node) {
+    const Node2D* n = &editor->graph.nodes[node];
+    editor->camera.x = n->x * editor->camera.scale - editor->viewWidth / 2;
+    editor->camera.y = n->y * editor->camera.scale - editor->viewHeight / 2;
+}
+
+static int next_alive(const Graph* graph, int* cursor) {
+    while (*cursor < graph->nodeCount && !graph_node_alive(graph, *cursor)) (*cursor)++;
+    return *cursor < graph->nodeCount ? (*cursor)++ : -1;
+}
+
+// Feeds the events one frame of the phase would see.
+static void script_frame(Editor* editor, Script* script, Phase phase, int frame, int frames) {
+    const Graph* graph = &editor->graph;
+    float cx = editor->viewWidth / 2, cy = editor->viewHeight / 2;
+    switch (phase) {
+    case PHASE_PAN: {
+        if (frame == 0) send_button(SDL_EVENT_MOUSE_BUTTON_DOWN, SDL_BUTTON_MIDDLE, cx, cy);
+        for (int step = 1; step <= MOTION_REPORTS_PER_FRAME; step++) {
+            float t = (frame % 100) + (float)step / MOTION_REPORTS_PER_FRAME;
+            send_motion(cx + t * 4.0f, cy + t * 2.0f);
+        }
+        if (frame == frames - 1) send_button(SDL_EVENT_MOUSE_BUTTON_UP, SDL_BUTTON_MIDDLE, scriptMouseX, scriptMouseY);
+        break;
+    }
+    case PHASE_ZOOM:
+        send_motion(cx, cy);
+        send_wheel((frame / 10) % 2 ? -1.0f : 1.0f);
+        break;
+    case PHASE_OVERVIEW: {
+        if (frame == 0) {
+            editor->camera.scale = ZOOM_MIN;
+            center_on(editor, graph->nodeCount / 2);
+            send_button(SDL_EVENT_MOUSE_BUTTON_DOWN, SDL_BUTTON_MIDDLE, cx, cy);
+        }
+        for (int step = 1; step <= MOTION_REPORTS_PER_FRAME; step++) {
+            float angle = (frame + (float)step / MOTION_REPORTS_PER_FRAME) * 0.05f;
+            send_motion(cx + cosf(angle) * 200.0f, cy + sinf(angle) * 150.0f);
+        }
+        if (frame == frames - 1) send_button(SDL_EVENT_MOUSE_BUTTON_UP, SDL_BUTTON_MIDDLE, scriptMouseX, scriptMouseY);
+        break;
+    }
+    case PHASE_DRAG:
+    case PHASE_AUTOSAVE: {
+        const Node2D* hub = &graph->nodes[script->hub];
+        if (frame == 0) {
+            center_on(editor, script->hub);
+            send_button(SDL_EVENT_MOUSE_BUTTON_DOWN, SDL_BUTTON_LEFT,
+                        screen_x(editor, hub->x + hub->width / 2), screen_y(editor, hub->y + HEADER_HEIGHT / 2));
+        }
+        for (int step = 1; step <= MOTION_REPORTS_PER_FRAME; step++) {
+            float angle = (frame + (float)step / MOTION_REPORTS_PER_FRAME) * 0.05f;
+            send_motion(cx + cosf(angle) * 200.0f, cy + sinf(angle) * 150.0f);
+        }
+        if (frame == frames - 1) send_button(SDL_EVENT_MOUSE_BUTTON_UP, SDL_BUTTON_LEFT, scriptMouseX, scriptMouseY);
+        break;
+    }
+    case PHASE_CONNECT: {
+        int from = next_alive(graph, &script->connectFrom);
+        int to = -1;
+        while (from != -1 && (to = next_alive(graph, &script->connectTo)) != -1) {
+            if (to != from && !graph_input_used(graph, to, 0)) break;
+        }
+        if (from == -1 || to == -1) break;
+        center_on(editor, to);
+        const Node2D* a = &graph->nodes[from];
+        const Node2D* b = &graph->nodes[to];
+        send_button(SDL_EVENT_MOUSE_BUTTON_DOWN, SDL_BUTTON_LEFT, screen_x(editor, a->outputX), screen_y(editor, a->outputY));
+        send_motion(screen_x(editor, b->inputX), screen_y(editor, b->inputY[0]));
+        send_button(SDL_EVENT_MOUSE_BUTTON_UP, SDL_BUTTON_LEFT, screen_x(editor, b->inputX), screen_y(editor, b->inputY[0]));
+        break;
+    }
+    case PHASE_UNDO:
+        if (frame == 0) {
+            // One entry, as a box-select delete would record it.
+            int* batch = malloc(BENCH_UNDO_BATCH * sizeof(int));
+            int count = 0, cursor = 0, node;
+            while (batch && count < BENCH_UNDO_BATCH && (node = next_alive(graph, &cursor)) != -1) batch[count++] = node;
+            undo_begin(&editor->undo);
+            editor_delete_nodes(editor, batch, count);
+            undo_end(&editor->undo);
+            free(batch);
+            script->batchDeleted = true;
+        } else if (script->batchDeleted) {
+            send_key(SDLK_Z, SDL_KMOD_CTRL);
+            script->batchDeleted = false;
+        } else if (frame < frames - 1) {
+            send_key(SDLK_Y, SDL_KMOD_CTRL); // the graph is left as it was for the delete phase
+            script->batchDeleted = true;
+        }
+        break;
+    case PHASE_DELETE: {
+        int node = next_alive(graph, &script->deleteNext);
+        if (node == -1) break;
+        const Node2D* n = &graph->nodes[node];
+        float x = screen_x(editor, n->x + n->width / 2), y = screen_y(editor, n->y + HEADER_HEIGHT / 2);
+        send_button(SDL_EVENT_MOUSE_BUTTON_DOWN, SDL_BUTTON_LEFT, x, y);
+        send_key(SDLK_DELETE, 0);
+        send_button(SDL_EVENT_MOUSE_BUTTON_UP, SDL_BUTTON_LEFT, x, y);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double* sorted, int count, double p) {
+    int index = (int)ceil(p * count) - 1;
+    if (index < 0) index = 0;
+    if (index >= count) index = count - 1;
+    return sorted[index];
+}
+
+int main(int argc, char* argv[]) {
+    int nodeCount = 10000, degree = 2, frames = 300;
+    StreamMode streamMode = STREAM_PERSISTENT;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--nodes") == 0) nodeCount = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--degree") == 0) degree = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--frames") == 0) frames = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--stream") == 0) {
+            streamMode = 0;
+            while (streamMode < STREAM_MODE_COUNT && strcmp(argv[i + 1], stream_buffer_mode_name(streamMode)) != 0) streamMode++;
+        }
+    }
+    if (nodeCount < 2 || frames < 1 || streamMode == STREAM_MODE_COUNT) {
+        fprintf(stderr, "Usage: bench_editor [--nodes N] [--degree D] [--frames F] [--stream persistent|unsynchronized|orphan]\n");
+        return 1;
+    }
+
+    if (!SDL_Init(SDL_INIT_VIDEO)) {
+        fprintf(stderr, "SDL_Init failed: %s\n", SDL_GetError());
+        return 1;
+    }
+    if (!TTF_Init()) {
+        fprintf(stderr, "TTF_Init failed: %s\n", SDL_GetError());
+        SDL_Quit();
+        return 1;
+    }
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+    SDL_Window* window = SDL_CreateWindow("bench_editor", WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+    SDL_GLContext glContext = window ? SDL_GL_CreateContext(window) : NULL;
+    if (!glContext || !gladLoadGL((GLADloadfunc)SDL_GL_GetProcAddress)) {
+        fprintf(stderr, "No GL 3.3 context: %s\n", SDL_GetError());
+        if (window) SDL_DestroyWindow(window);
+        TTF_Quit();
+        SDL_Quit();
+        return 1;
+    }
+    SDL_GL_SetSwapInterval(0);
+
+    // Hidden windows may have no usable default framebuffer, so render into our own.
+    GLuint fbo, colorBuffer;
+    glGenFramebuffers(1, &fbo);
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, WINDOW_WIDTH, WINDOW_HEIGHT);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    TTF_Font* font = TTF_OpenFont("Kenney Mini.ttf", 24);
+    Editor editor;
+    if (!font || !editor_init(&editor, font, WINDOW_WIDTH, WINDOW_HEIGHT) || !input_frame_init(&scriptInput)) {
+        fprintf(stderr, "Failed to set up the editor: %s\n", SDL_GetError());
+        return 1;
+    }
+    if (streamMode != STREAM_PERSISTENT) {
+        stream_buffer_destroy(&editor.stream);
+        if (!stream_buffer_init(&editor.stream, VERTEX_STREAM_BYTES, streamMode)) return 1;
+    }
+
+    srand(1);
+    Script script = {0};
+    double buildStart = now_seconds();
+    build_graph(&editor, &script, nodeCount, degree);
+    double buildSeconds = now_seconds() - buildStart;
+    int edgeCount = editor.graph.connectionCount;
+
+    printf("{\n  \"renderer\": \"%s\",\n  \"stream\": \"%s\",\n  \"nodes\": %d,\n  \"edges\": %d,\n"
+           "  \"build_ms\": %.2f,\n  \"phases\": [\n",
+           (const char*)glGetString(GL_RENDERER), stream_buffer_mode_name(editor.stream.mode), nodeCount, edgeCount,
+           buildSeconds * 1e3);
+
+    double* times = malloc((size_t)frames * sizeof(double));
+    bool steadyAllocationFree = true;
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        // Every phase starts from the same view so the numbers are comparable.
+        editor.camera = (Camera){0.0f, 0.0f, 1.0f};
+        long long drawCalls = 0, uploadBytes = 0, textureUploads = 0, fenceWaits = 0, received = 0, dispatched = 0;
+        long long heapCalls = 0, steadyHeapCalls = 0; // the latter in the second half of the phase
+        float snapshotMsMax = 0.0f;
+        if (phase == PHASE_AUTOSAVE) autosave_start(&editor.autosave, BENCH_AUTOSAVE_PATH, 0);
+        clock_t cpuStart = clock();
+        for (int f = 0; f < frames; f++) {
+            gl_stats_reset();
+            double start = now_seconds();
+            input_frame_begin(&scriptInput);
+            script_frame(&editor, &script, (Phase)phase, f, frames);
+            for (int i = 0; i < scriptInput.count; i++) editor_handle_event(&editor, &scriptInput.events[i]);
+            received += scriptInput.received;
+            dispatched += scriptInput.count;
+            if (phase == PHASE_AUTOSAVE) {
+                autosave_update(&editor.autosave, &editor.graph);
+                if (editor.autosave.snapshotMs > snapshotMsMax) snapshotMsMax = editor.autosave.snapshotMs;
+            }
+            glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            editor_render(&editor);
+            glFinish();
+            editor_end_frame(&editor);
+            times[f] = now_seconds() - start;
+            heapCalls += editor.frameHeapCalls;
+            if (f >= frames / 2) steadyHeapCalls += editor.frameHeapCalls;
+            editor.frameMs = (float)(times[f] * 1e3);
+            drawCalls += renderStats.drawCalls;
+            uploadBytes += renderStats.uploadBytes;
+            textureUploads += renderStats.textureUploads;
+            fenceWaits += renderStats.fenceWaits;
+        }
+        double cpuSeconds = (double)(clock() - cpuStart) / CLOCKS_PER_SEC;
+        if (steadyPhases[phase] && steadyHeapCalls > 0) {
+            fprintf(stderr, "%s: %lld heap calls after warming up, expected none\n", phaseNames[phase], steadyHeapCalls);
+            steadyAllocationFree = false;
+        }
+        int autosaves = 0;
+        float snapshotMs = 0.0f, writeMs = 0.0f;
+        autosave_stats(&editor.autosave, &autosaves, &snapshotMs, &writeMs);
+
+        double total = 0.0;
+        for (int f = 0; f < frames; f++) total += times[f];
+        qsort(times, frames, sizeof(double), compare_doubles);
+        printf("    {\"name\": \"%s\", \"frames\": %d, \"mean_ms\": %.3f, \"p50_ms\": %.3f, \"p99_ms\": %.3f, "
+               "\"max_ms\": %.3f, \"cpu_ms_per_frame\": %.3f, \"draw_calls_per_frame\": %.1f, "
+               "\"upload_bytes_per_frame\": %.0f, \"texture_uploads\": %lld, \"fence_waits\": %lld, \"heap_calls_per_frame\": %.2f, "
+               "\"steady_heap_calls\": %lld, \"events_per_frame\": %.1f, "
+               "\"dispatched_per_frame\": %.1f, \"autosaves\": %d, \"snapshot_ms_max\": %.3f, "
+               "\"last_write_ms\": %.1f, \"undo_bytes\": %zu, \"edges_after\": %d}%s\n",
+               phaseNames[phase], frames, total / frames * 1e3, percentile(times, frames, 0.50) * 1e3,
+               percentile(times, frames, 0.99) * 1e3, times[frames - 1] * 1e3, cpuSeconds / frames * 1e3,
+               (double)drawCalls / frames, (double)uploadBytes / frames, textureUploads, fenceWaits,
+               (double)heapCalls / frames, steadyHeapCalls,
+               (double)received / frames, (double)dispatched / frames, autosaves, snapshotMsMax, writeMs,
+               undo_bytes_used(&editor.undo), editor.graph.connectionCount, phase + 1 < PHASE_COUNT ? "," : "");
+    }
+    printf("  ]\n}\n");
+
+    free(times);
+    input_frame_destroy(&scriptInput);
+    editor_destroy(&editor); // waits for the last autosave
+    remove(BENCH_AUTOSAVE_PATH);
+    TTF_CloseFont(font);
+    glDeleteRenderbuffers(1, &colorBuffer);
+    glDeleteFramebuffers(1, &fbo);
+    SDL_GL_DestroyContext(glContext);
+    SDL_DestroyWindow(window);
+    TTF_Quit();
+    SDL_Quit();
+    return steadyAllocationFree ? 0 : 1;
+}
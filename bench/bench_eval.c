@@ -0,0 +1,155 @@
+// Dataflow evaluation speed: plan compile time, full-pass throughput and the cost of an
+// incremental update after one input changes. Builds a random typed DAG, then checks that
+// incremental updates, and a cycle being introduced and broken again, end with the same
+// values as a fresh full evaluation. Exits with 1 if anything differs.
+// Usage: bench_eval [nodes] [passes]
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "graph.h"
+#include "eval.h"
+#include "bench_util.h"
+#include "bench_dataflow.h"
+
+#define ROOTS 1024  // Variables and Toggles at the start, the graph's inputs
+#define WINDOW 256  // inputs come from at most this many nodes back
+#define UPDATES 200 // single-input changes timed incrementally
+
+static bool same_values(const Evaluator* a, const Evaluator* b, const Graph* graph) {
+    for (int i = 0; i < graph->nodeCount; i++) {
+        if (eval_has_value(a, i) != eval_has_value(b, i)) return false;
+        if (!eval_has_value(a, i)) continue;
+        float x = eval_value(a, i), y = eval_value(b, i);
+        if (!same_bits(x, y) && !(isnan(x) && isnan(y))) return false;
+    }
+    return true;
+}
+
+// What the incrementally maintained values must equal.
+static bool matches_fresh(const Evaluator* eval, const Graph* graph) {
+    Evaluator fresh;
+    eval_init(&fresh);
+    bool same = eval_update(&fresh, graph) != -1 && same_values(eval, &fresh, graph);
+    eval_destroy(&fresh);
+    return same;
+}
+
+// d = 1 / (x * y) with x = 0: flipping y's sign turns the product from 0 into -0, which the
+// update must pass on even though the two compare equal, so d goes from inf to -inf.
+static bool sign_flip_matches(void) {
+    Graph graph;
+    Evaluator eval;
+    if (!graph_init(&graph) || !eval_init(&eval)) return false;
+    int x = graph_add_node(&graph, 0.0f, 0.0f, "x");
+    int y = graph_add_node(&graph, 0.0f, 0.0f, "y");
+    int one = graph_add_node(&graph, 0.0f, 0.0f, "one");
+    int m = graph_add_node(&graph, 0.0f, 0.0f, "m");
+    int d = graph_add_node(&graph, 0.0f, 0.0f, "d");
+    graph.nodes[x].value = 0.0f;
+    graph.nodes[y].value = 1.0f;
+    graph.nodes[one].value = 1.0f;
+    graph.nodes[m].type = NODE_MULTIPLY;
+    graph.nodes[d].type = NODE_DIVIDE;
+    graph_add_connection(&graph, x, m, 0);
+    graph_add_connection(&graph, y, m, 1);
+    graph_add_connection(&graph, one, d, 0);
+    graph_add_connection(&graph, m, d, 1);
+    eval_update(&eval, &graph);
+    graph.nodes[y].value = -1.0f;
+    eval_mark_node(&eval, y);
+    eval_update(&eval, &graph);
+    bool same = matches_fresh(&eval, &graph) && eval_value(&eval, d) < 0.0f;
+    eval_destroy(&eval);
+    graph_destroy(&graph);
+    return same;
+}
+
+// A root Variable the node depends on, found by walking its inputs backwards.
+static int upstream_variable(const Graph* graph, int node) {
+    int* stack = malloc((size_t)graph->nodeCount * sizeof(int));
+    unsigned char* seen = calloc((size_t)graph->nodeCount, 1);
+    int found = -1, top = 0;
+    if (stack && seen) stack[top++] = node;
+    while (top > 0 && found == -1) {
+        int n = stack[--top];
+        if (graph->nodes[n].type == NODE_VARIABLE && !graph_input_used(graph, n, 0)) found = n;
+        for (int c = graph_first_in(graph, n); c != -1; c = graph_next_in(graph, c)) {
+            int from = graph->connections[c].fromNode;
+            if (!seen[from]) {
+                seen[from] = 1;
+                stack[top++] = from;
+            }
+        }
+    }
+    free(stack);
+    free(seen);
+    return found;
+}
+
+int main(int argc, char* argv[]) {
+    int nodeCount = argc > 1 ? atoi(argv[1]) : 1000000;
+    int passes = argc > 2 ? atoi(argv[2]) : 20;
+    if (nodeCount < 2 * ROOTS) nodeCount = 2 * ROOTS;
+    srand(1);
+
+    Graph graph;
+    Evaluator eval;
+    if (!graph_init(&graph) || !eval_init(&eval)) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    build_dataflow(&graph, nodeCount, ROOTS, WINDOW, true);
+
+    double start = now_seconds();
+    if (!eval_compile(&eval, &graph)) return 1;
+    double compileSeconds = now_seconds() - start;
+
+    start = now_seconds();
+    for (int p = 0; p < passes; p++) eval_run(&eval, &graph);
+    double runSeconds = now_seconds() - start;
+    eval_update(&eval, &graph); // clears the marks left by the first compile
+
+    // Change one Variable at a time; only its downstream cone is recomputed.
+    long long updated = 0;
+    start = now_seconds();
+    for (int u = 0; u < UPDATES; u++) {
+        int root = 1 + 4 * (rand() % (ROOTS / 4)); // not a multiple of 4: a Variable
+        graph.nodes[root].value += 1.0f;
+        eval_mark_node(&eval, root);
+        updated += eval_update(&eval, &graph);
+    }
+    double updateSeconds = now_seconds() - start;
+    bool same = matches_fresh(&eval, &graph);
+
+    // Feed a late node back into a root: everything downstream of that root loses its value
+    // until the connection is removed again.
+    int late = -1;
+    for (int i = nodeCount - 1; i >= ROOTS && late == -1; i--) {
+        if (nodeSignatures[graph.nodes[i].type].output == VALUE_NUMBER && graph_first_in(&graph, i) != -1) late = i;
+    }
+    int root = upstream_variable(&graph, late);
+    if (root == -1) return 1;
+    int back = graph_add_connection(&graph, late, root, 0);
+    eval_mark_structure(&eval);
+    eval_mark_node(&eval, root);
+    start = now_seconds();
+    eval_update(&eval, &graph);
+    double cycleSeconds = now_seconds() - start;
+    int cyclic = eval.cyclicCount;
+    same = same && matches_fresh(&eval, &graph);
+    graph_remove_connection(&graph, back);
+    eval_mark_structure(&eval);
+    eval_mark_node(&eval, root);
+    eval_update(&eval, &graph);
+    same = same && eval.cyclicCount == 0 && matches_fresh(&eval, &graph);
+    same = same && sign_flip_matches();
+
+    printf("nodes=%d edges=%d mistyped=%d compile_ms=%.2f full_pass_ms=%.2f evals_per_sec=%.3g "
+           "update_avg_nodes=%.0f update_avg_ms=%.3f cycle_nodes=%d cycle_update_ms=%.2f incremental=%s\n",
+           graph.liveNodeCount, graph.connectionCount, eval.mistypedCount, compileSeconds * 1e3,
+           runSeconds * 1e3 / passes, (double)eval.stepCount * passes / runSeconds, (double)updated / UPDATES,
+           updateSeconds * 1e3 / UPDATES, cyclic, cycleSeconds * 1e3, same && cyclic > 0 ? "ok" : "MISMATCH");
+    eval_destroy(&eval);
+    graph_destroy(&graph);
+    return same && cyclic > 0 ? 0 : 1;
+}
@@ -0,0 +1,46 @@
+// Save and load time of the binary graph file, with a round-trip check.
+// Builds a lattice graph with some nodes removed, saves it, maps it back and compares every
+// node and connection. Exits with 1 if anything differs.
+// Usage: bench_graph_file [nodes] [path]
+#include <stdio.h>
+#include <stdlib.h>
+#include "graph.h"
+#include "graph_file.h"
+#include "bench_util.h"
+#include "bench_lattice.h"
+
+int main(int argc, char* argv[]) {
+    int nodeCount = argc > 1 ? atoi(argv[1]) : 1000000;
+    const char* path = argc > 2 ? argv[2] : "bench_graph_file.n2d";
+
+    Graph graph, loaded;
+    if (!graph_init(&graph) || !graph_init(&loaded)) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    build_lattice(&graph, nodeCount, false);
+
+    double start = now_seconds();
+    if (!graph_file_save(&graph, path)) return 1;
+    double saveSeconds = now_seconds() - start;
+
+    start = now_seconds();
+    GraphFile file;
+    if (!graph_file_open(&file, path)) return 1;
+    double openSeconds = now_seconds() - start;
+    size_t fileBytes = file.size;
+
+    start = now_seconds();
+    bool read = graph_file_read(&file, &loaded);
+    double readSeconds = now_seconds() - start;
+    graph_file_close(&file);
+
+    bool same = read && same_graph(&graph, &loaded);
+    printf("nodes=%d edges=%d file_bytes=%zu save_ms=%.2f open_ms=%.3f read_ms=%.2f round_trip=%s\n",
+           graph.liveNodeCount, graph.connectionCount, fileBytes, saveSeconds * 1e3, openSeconds * 1e3,
+           readSeconds * 1e3, same ? "ok" : "MISMATCH");
+    remove(path);
+    graph_destroy(&loaded);
+    graph_destroy(&graph);
+    return same ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+// Streaming JSON export and import speed, with a round-trip check.
+// Builds a lattice graph (700k nodes by default, a file of about 100 MB), writes it, reads it
+// back with the pull parser and compares every node and connection. Exits with 1 if
+// anything differs.
+// Usage: bench_graph_json [nodes] [path]
+#include <stdio.h>
+#include <stdlib.h>
+#include "graph.h"
+#include "graph_json.h"
+#include "bench_util.h"
+#include "bench_lattice.h"
+
+int main(int argc, char* argv[]) {
+    int nodeCount = argc > 1 ? atoi(argv[1]) : 700000;
+    const char* path = argc > 2 ? argv[2] : "bench_graph_json.json";
+
+    Graph graph, loaded;
+    if (!graph_init(&graph) || !graph_init(&loaded)) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    build_lattice(&graph, nodeCount, true);
+
+    double start = now_seconds();
+    if (!graph_json_save(&graph, path)) return 1;
+    double writeSeconds = now_seconds() - start;
+
+    FILE* file = fopen(path, "rb");
+    long fileBytes = 0;
+    if (file) {
+        fseek(file, 0, SEEK_END);
+        fileBytes = ftell(file);
+        fclose(file);
+    }
+
+    start = now_seconds();
+    bool read = graph_json_load(&loaded, path);
+    double readSeconds = now_seconds() - start;
+
+    bool same = read && same_graph(&graph, &loaded);
+    double megabytes = fileBytes / 1e6;
+    printf("nodes=%d edges=%d file_mb=%.1f write_ms=%.1f read_ms=%.1f write_mbps=%.0f read_mbps=%.0f "
+           "parser_bytes=%zu round_trip=%s\n",
+           graph.liveNodeCount, graph.connectionCount, megabytes, writeSeconds * 1e3, readSeconds * 1e3,
+           megabytes / writeSeconds, megabytes / readSeconds, sizeof(JsonReader), same ? "ok" : "MISMATCH");
+    remove(path);
+    graph_destroy(&loaded);
+    graph_destroy(&graph);
+    return same ? 0 : 1;
+}
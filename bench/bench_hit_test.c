@@ -0,0 +1,111 @@
+// Pick latency of the hit-test service against the linear scans it replaced. Every header
+// pick the linear scan makes must return the same node; exits with 1 if one does not.
+// Usage: bench_hit_test [picks]
+#include <stdio.h>
+#include <stdlib.h>
+#include "hit_test.h"
+#include "bench_util.h"
+
+static int linear_header(const Node2D* nodes, int nodeCount, float worldX, float worldY) {
+    for (int i = nodeCount - 1; i >= 0; i--) {
+        if (worldX >= nodes[i].x && worldX <= nodes[i].x + nodes[i].width &&
+            worldY >= nodes[i].y && worldY <= nodes[i].y + HEADER_HEIGHT) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool run(int nodeCount, int picks) {
+    Node2D* nodes = malloc(nodeCount * sizeof(Node2D));
+    Connection* connections = malloc(nodeCount * sizeof(Connection));
+    if (!nodes || !connections) {
+        printf("Out of memory for %d nodes\n", nodeCount);
+        exit(1);
+    }
+
+    // Nodes on a jittered lattice, each connected to a nearby node.
+    int side = 1;
+    while (side * side < nodeCount) side++;
+    float extent = side * 150.0f;
+    for (int i = 0; i < nodeCount; i++) {
+        nodes[i].x = (i % side) * 150.0f + random_range(-20.0f, 20.0f);
+        nodes[i].y = (i / side) * 150.0f + random_range(-20.0f, 20.0f);
+        nodes[i].width = 100.0f;
+        nodes[i].height = 100.0f;
+        snprintf(nodes[i].name, sizeof(nodes[i].name), "Node %d", i);
+        nodes[i].type = NODE_VARIABLE;
+        nodes[i].value = 0.0f;
+        node_update_slots(&nodes[i]);
+    }
+    int connectionCount = 0;
+    for (int i = 0; i + 1 < nodeCount; i++) {
+        int to = i + 1 + rand() % 3;
+        if (to >= nodeCount) continue;
+        connections[connectionCount].fromNode = i;
+        connections[connectionCount].toNode = to;
+        connections[connectionCount].toSlot = 0;
+        connectionCount++;
+    }
+
+    HitTest hitTest;
+    if (!hit_test_init(&hitTest)) {
+        printf("Failed to create hit tester\n");
+        exit(1);
+    }
+    double start = now_seconds();
+    for (int i = 0; i < nodeCount; i++) hit_test_update_node(&hitTest, nodes, i);
+    for (int i = 0; i < connectionCount; i++) hit_test_update_wire(&hitTest, nodes, connections, i);
+    double buildSeconds = now_seconds() - start;
+
+    float* points = malloc(picks * 2 * sizeof(float));
+    for (int i = 0; i < picks; i++) {
+        points[i * 2] = random_range(0.0f, extent);
+        points[i * 2 + 1] = random_range(0.0f, extent);
+    }
+
+    int hits = 0;
+    start = now_seconds();
+    for (int i = 0; i < picks; i++) hits += hit_test_header(&hitTest, nodes, points[i * 2], points[i * 2 + 1]) != -1;
+    double headerSeconds = now_seconds() - start;
+
+    start = now_seconds();
+    for (int i = 0; i < picks; i++) hits += hit_test_output_slot(&hitTest, nodes, points[i * 2], points[i * 2 + 1], SLOT_RADIUS) != -1;
+    double slotSeconds = now_seconds() - start;
+
+    start = now_seconds();
+    for (int i = 0; i < picks; i++) hits += hit_test_wire(&hitTest, nodes, connections, points[i * 2], points[i * 2 + 1], DISCONNECT_DISTANCE) != -1;
+    double wireSeconds = now_seconds() - start;
+
+    // The linear scan is far slower, so it only gets a fraction of the picks.
+    int linearPicks = picks / 100 > 0 ? picks / 100 : 1;
+    start = now_seconds();
+    for (int i = 0; i < linearPicks; i++) hits += linear_header(nodes, nodeCount, points[i * 2], points[i * 2 + 1]) != -1;
+    double linearSeconds = now_seconds() - start;
+
+    int mismatches = 0;
+    for (int i = 0; i < linearPicks; i++) {
+        float x = points[i * 2], y = points[i * 2 + 1];
+        mismatches += hit_test_header(&hitTest, nodes, x, y) != linear_header(nodes, nodeCount, x, y);
+    }
+
+    printf("nodes=%d edges=%d build_ms=%.2f header_ns=%.1f slot_ns=%.1f wire_ns=%.1f linear_header_ns=%.1f hits=%d "
+           "match=%s\n",
+           nodeCount, connectionCount, buildSeconds * 1e3,
+           headerSeconds * 1e9 / picks, slotSeconds * 1e9 / picks, wireSeconds * 1e9 / picks,
+           linearSeconds * 1e9 / linearPicks, hits, mismatches == 0 ? "ok" : "MISMATCH");
+
+    hit_test_destroy(&hitTest);
+    free(points);
+    free(connections);
+    free(nodes);
+    return mismatches == 0;
+}
+
+int main(int argc, char* argv[]) {
+    int picks = argc > 1 ? atoi(argv[1]) : 200000;
+    srand(1);
+    bool same = run(10000, picks);
+    same = run(100000, picks) && same;
+    return same ? 0 : 1;
+}
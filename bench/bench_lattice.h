@@ -0,0 +1,67 @@
+#ifndef BENCH_LATTICE_H
+#define BENCH_LATTICE_H
+
+// The lattice graph the file format benchmarks save and load, and the round-trip check.
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "graph.h"
+
+// Nodes on a square grid with every type and value, each connected to its right and lower
+// neighbours where the target has that input. Positions have fractions so they only
+// round-trip if every bit is kept; with escapedNames every 50th name holds a quote and a tab.
+static inline void build_lattice(Graph* graph, int nodeCount, bool escapedNames) {
+    int side = 1;
+    while (side * side < nodeCount) side++;
+    graph_reserve(graph, nodeCount, nodeCount * 2);
+    for (int i = 0; i < nodeCount; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), escapedNames && i % 50 == 0 ? "Node \"%d\"\t" : "Node %d", i);
+        int n = graph_add_node(graph, (i % side) * 150.0f + 0.1f * (i % 7), (i / side) * 150.0f - 0.3f, name);
+        graph->nodes[n].type = (NodeType)(i % NODE_TYPE_COUNT);
+        graph->nodes[n].value = i * 0.25f;
+        node_update_slots(&graph->nodes[n]);
+    }
+    for (int i = 0; i + 1 < nodeCount; i++) {
+        // Only into inputs the target type has, as the loaders validate.
+        if (node_input_count(graph->nodes[i + 1].type) > 0) graph_add_connection(graph, i, i + 1, 0);
+        if (i + side < nodeCount && node_input_count(graph->nodes[i + side].type) > 1) {
+            graph_add_connection(graph, i, i + side, 1);
+        }
+    }
+    // Leave holes in the slot array so saving has to renumber.
+    for (int i = 7; i < nodeCount; i += 97) {
+        while (graph_first_out(graph, i) != -1) graph_remove_connection(graph, graph_first_out(graph, i));
+        while (graph_first_in(graph, i) != -1) graph_remove_connection(graph, graph_first_in(graph, i));
+        graph_remove_node(graph, i);
+    }
+}
+
+// Live nodes keep their slot order through a save, so the n-th live node of the original is
+// node n of the loaded graph.
+static inline bool same_graph(const Graph* a, const Graph* b) {
+    if (a->liveNodeCount != b->liveNodeCount || a->connectionCount != b->connectionCount) return false;
+    int* position = malloc((size_t)a->nodeCount * sizeof(int));
+    if (!position) return false;
+    int n = 0;
+    bool same = true;
+    for (int i = 0; i < a->nodeCount && same; i++) {
+        if (!graph_node_alive(a, i)) continue;
+        const Node2D* x = &a->nodes[i];
+        const Node2D* y = &b->nodes[n];
+        position[i] = n++;
+        same = x->x == y->x && x->y == y->y && x->width == y->width && x->height == y->height &&
+               x->inputX == y->inputX && x->outputY == y->outputY && strcmp(x->name, y->name) == 0 &&
+               x->type == y->type && x->value == y->value;
+    }
+    for (int c = 0; c < a->connectionCount && same; c++) {
+        same = position[a->connections[c].fromNode] == b->connections[c].fromNode &&
+               position[a->connections[c].toNode] == b->connections[c].toNode &&
+               a->connections[c].toSlot == b->connections[c].toSlot;
+    }
+    free(position);
+    return same;
+}
+
+#endif
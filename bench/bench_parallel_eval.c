@@ -0,0 +1,89 @@
+// Parallel evaluation scaling: full-pass time at 1, 2, 4, 8 and 16 threads on graphs of the
+// same size but different shapes, from a few very wide levels to many narrow ones, and the
+// speedup over one thread. Every parallel pass must reproduce the single-threaded values
+// exactly; exits with 1 if one does not.
+// Usage: bench_parallel_eval [nodes] [passes]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "graph.h"
+#include "eval.h"
+#include "bench_util.h"
+
+typedef struct {
+    const char* name;
+    int width; // nodes per level
+} Shape;
+
+static const Shape shapes[] = {
+    {"wide", 131072},
+    {"deep", 8192},
+    {"narrow", 256}, // below EVAL_PARALLEL_MIN_STEPS: stays on one thread
+};
+static const int threadCounts[] = {1, 2, 4, 8, 16};
+
+// Levels of width nodes. The first holds Variables; every later node combines two random
+// nodes of the level before it, so the level structure is exactly the built one.
+static void build(Graph* graph, int nodeCount, int width) {
+    static const NodeType operations[] = {NODE_ADD, NODE_SUBTRACT, NODE_MULTIPLY, NODE_MIN, NODE_MAX};
+    graph_reserve(graph, nodeCount, nodeCount * 2);
+    for (int i = 0; i < nodeCount; i++) {
+        int n = graph_add_node(graph, 0.0f, 0.0f, "");
+        Node2D* node = &graph->nodes[n];
+        if (i < width) {
+            node->value = (float)(rand() % 100) * 0.01f;
+            continue;
+        }
+        node->type = operations[rand() % 5];
+        int previous = i - i % width - width;
+        graph_add_connection(graph, previous + rand() % width, n, 0);
+        graph_add_connection(graph, previous + rand() % width, n, 1);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int nodeCount = argc > 1 ? atoi(argv[1]) : 1 << 20;
+    int passes = argc > 2 ? atoi(argv[2]) : 10;
+    srand(1);
+    printf("logical_cores=%d\n", SDL_GetNumLogicalCPUCores());
+
+    bool allMatch = true;
+    for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) {
+        Graph graph;
+        Evaluator eval;
+        if (!graph_init(&graph) || !eval_init(&eval)) {
+            printf("Out of memory\n");
+            return 1;
+        }
+        build(&graph, nodeCount, shapes[s].width);
+        if (!eval_compile(&eval, &graph)) return 1;
+        eval_run(&eval, &graph);
+        float* reference = malloc((size_t)graph.nodeCount * sizeof(float));
+        if (!reference) return 1;
+        memcpy(reference, eval.values, (size_t)graph.nodeCount * sizeof(float));
+
+        double baseMs = 0.0;
+        for (size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); t++) {
+            TaskPool pool;
+            task_pool_init(&pool, threadCounts[t]);
+            eval.pool = &pool;
+            memset(eval.values, 0, (size_t)graph.nodeCount * sizeof(float));
+            eval_run(&eval, &graph); // warm up the threads and caches
+            double start = now_seconds();
+            for (int p = 0; p < passes; p++) eval_run(&eval, &graph);
+            double passMs = (now_seconds() - start) * 1e3 / passes;
+            if (t == 0) baseMs = passMs;
+            bool match = memcmp(reference, eval.values, (size_t)graph.nodeCount * sizeof(float)) == 0;
+            allMatch = allMatch && match;
+            printf("shape=%s nodes=%d levels=%d threads=%d pass_ms=%.2f speedup=%.2f steals=%d match=%s\n",
+                   shapes[s].name, graph.liveNodeCount, eval.levelCount, pool.threadCount, passMs, baseMs / passMs,
+                   atomic_load(&pool.steals), match ? "ok" : "MISMATCH");
+            eval.pool = NULL;
+            task_pool_destroy(&pool);
+        }
+        free(reference);
+        eval_destroy(&eval);
+        graph_destroy(&graph);
+    }
+    return allMatch ? 0 : 1;
+}
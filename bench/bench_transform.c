@@ -0,0 +1,61 @@
+// Throughput of the world-to-NDC rectangle transform, vectorized against plain C.
+// Usage: bench_transform [rects] [passes]
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "ndc_transform.h"
+#include "bench_util.h"
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 100000;
+    int passes = argc > 2 ? atoi(argv[2]) : 2000;
+    srand(1);
+
+    // Inputs and both outputs in one block: x, y, width, height, then two sets of four edges.
+    float* block = malloc((size_t)count * 12 * sizeof(float));
+    if (!block) {
+        printf("Out of memory for %d rects\n", count);
+        return 1;
+    }
+    float* x = block;
+    float* y = x + count;
+    float* width = y + count;
+    float* height = width + count;
+    float* simd = height + count;
+    float* scalar = simd + (size_t)count * 4;
+    for (int i = 0; i < count; i++) {
+        x[i] = random_range(-50000.0f, 50000.0f);
+        y[i] = random_range(-50000.0f, 50000.0f);
+        width[i] = random_range(16.0f, 200.0f);
+        height[i] = random_range(16.0f, 200.0f);
+    }
+
+    Camera camera = {1234.5f, -678.0f, 0.75f};
+    NdcTransform transform = ndc_transform_from_camera(&camera, 800.0f, 600.0f);
+
+    double start = now_seconds();
+    for (int p = 0; p < passes; p++) {
+        ndc_transform_rects(&transform, x, y, width, height, count,
+                            simd, simd + count, simd + count * 2, simd + count * 3);
+    }
+    double simdSeconds = (now_seconds() - start) / passes;
+
+    start = now_seconds();
+    for (int p = 0; p < passes; p++) {
+        ndc_transform_rects_scalar(&transform, x, y, width, height, count,
+                                   scalar, scalar + count, scalar + count * 2, scalar + count * 3);
+    }
+    double scalarSeconds = (now_seconds() - start) / passes;
+
+    float maxError = 0.0f;
+    for (int i = 0; i < count * 4; i++) maxError = fmaxf(maxError, fabsf(simd[i] - scalar[i]));
+
+    // Four floats read and four written per rectangle.
+    double bytes = (double)count * 8 * sizeof(float);
+    printf("isa=%s rects=%d simd_us=%.1f scalar_us=%.1f simd_gbps=%.2f scalar_gbps=%.2f max_error=%g\n",
+           ndc_transform_isa(), count, simdSeconds * 1e6, scalarSeconds * 1e6,
+           bytes / simdSeconds * 1e-9, bytes / scalarSeconds * 1e-9, maxError);
+
+    free(block);
+    return maxError <= 1e-5f ? 0 : 1;
+}
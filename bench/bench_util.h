@@ -0,0 +1,26 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+// Helpers shared by the benchmarks. Header only, so each benchmark stays one source file.
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static inline double now_seconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static inline float random_range(float min, float max) {
+    return min + (max - min) * ((float)rand() / (float)RAND_MAX);
+}
+
+// The evaluators must agree to the bit, so results are compared as bits: -0 and 0 differ,
+// and a NaN equals the same NaN.
+static inline bool same_bits(float a, float b) {
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+#endif
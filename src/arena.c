@@ -0,0 +1,28 @@
+#include "arena.h"
+#include "mem.h"
+#include <stdint.h>
+#include <string.h>
+
+bool arena_init(Arena* arena, size_t capacity) {
+    memset(arena, 0, sizeof(*arena));
+    // Room to align the start; malloc only promises alignment for the basic types.
+    arena->base = mem_alloc(capacity + ARENA_ALIGNMENT);
+    if (!arena->base) return false;
+    arena->capacity = capacity;
+    return true;
+}
+
+void arena_destroy(Arena* arena) {
+    mem_free(arena->base);
+    memset(arena, 0, sizeof(*arena));
+}
+
+void* arena_alloc(Arena* arena, size_t bytes) {
+    uintptr_t start = ((uintptr_t)arena->base + ARENA_ALIGNMENT - 1) & ~(uintptr_t)(ARENA_ALIGNMENT - 1);
+    size_t size = arena_size(bytes);
+    if (size > arena->capacity - arena->used) return NULL;
+    void* memory = (void*)(start + arena->used);
+    arena->used += size;
+    if (arena->used > arena->peak) arena->peak = arena->used;
+    return memory;
+}
@@ -0,0 +1,30 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define ARENA_ALIGNMENT 64 // a cache line, and enough for any vector load
+
+// Linear allocator over one block: allocating bumps an offset, and everything is freed at
+// once by resetting it. Memory that lives exactly as long as some pass, batch or frame comes
+// from here instead of separate mallocs, so once the block exists it costs no heap calls.
+typedef struct {
+    unsigned char* base;
+    size_t capacity;
+    size_t used;
+    size_t peak; // most ever used between resets, for sizing the block
+} Arena;
+
+// Returns false if the block cannot be allocated.
+bool arena_init(Arena* arena, size_t capacity);
+void arena_destroy(Arena* arena);
+// Returns ARENA_ALIGNMENT aligned memory, or NULL if the arena is full.
+void* arena_alloc(Arena* arena, size_t bytes);
+static inline void arena_reset(Arena* arena) { arena->used = 0; }
+// Space an allocation of bytes takes, padding included, for sizing an arena up front.
+static inline size_t arena_size(size_t bytes) {
+    return (bytes + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+}
+
+#endif
@@ -0,0 +1,239 @@
+#include "autosave.h"
+#include "graph_file.h"
+#include "mem.h"
+#include <stdio.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#define BLOCK_SIZE (1 << AUTOSAVE_BLOCK_SHIFT)
+
+static double elapsed_ms(Uint64 start) {
+    return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+// Blocks the bitmap did not cover yet count as dirty, since nothing of them was copied.
+static bool grow_blocks(unsigned char** dirty, int* capacity, int needed) {
+    if (needed <= *capacity) return true;
+    int newCapacity = *capacity ? *capacity : 64;
+    while (newCapacity < needed) newCapacity *= 2;
+    unsigned char* grown = mem_realloc(*dirty, newCapacity);
+    if (!grown) return false;
+    memset(grown + *capacity, 1, newCapacity - *capacity);
+    *dirty = grown;
+    *capacity = newCapacity;
+    return true;
+}
+
+static bool grow_items(void** items, int* capacity, int needed, size_t itemSize) {
+    if (needed <= *capacity) return true;
+    int newCapacity = *capacity ? *capacity : BLOCK_SIZE;
+    while (newCapacity < needed) newCapacity *= 2;
+    void* grown = mem_realloc(*items, (size_t)newCapacity * itemSize);
+    if (!grown) return false;
+    *items = grown;
+    *capacity = newCapacity;
+    return true;
+}
+
+void autosave_init(Autosave* autosave) {
+    memset(autosave, 0, sizeof(*autosave));
+    autosave->pending = -1;
+    autosave->writing = -1;
+}
+
+void autosave_mark_node(Autosave* autosave, int index) {
+    int block = index >> AUTOSAVE_BLOCK_SHIFT;
+    for (int s = 0; s < 2; s++) {
+        AutosaveSnapshot* snapshot = &autosave->snapshots[s];
+        // A failed grow leaves the block uncovered, and uncovered blocks are copied anyway.
+        if (grow_blocks(&snapshot->nodeDirty, &snapshot->nodeBlockCapacity, block + 1)) snapshot->nodeDirty[block] = 1;
+    }
+    autosave->changed = true;
+}
+
+void autosave_mark_connection(Autosave* autosave, int index) {
+    int block = index >> AUTOSAVE_BLOCK_SHIFT;
+    for (int s = 0; s < 2; s++) {
+        AutosaveSnapshot* snapshot = &autosave->snapshots[s];
+        if (grow_blocks(&snapshot->connectionDirty, &snapshot->connectionBlockCapacity, block + 1)) {
+            snapshot->connectionDirty[block] = 1;
+        }
+    }
+    autosave->changed = true;
+}
+
+void autosave_mark_all(Autosave* autosave, const Graph* graph) {
+    for (int s = 0; s < 2; s++) {
+        AutosaveSnapshot* snapshot = &autosave->snapshots[s];
+        memset(snapshot->nodeDirty, 1, snapshot->nodeBlockCapacity);
+        memset(snapshot->connectionDirty, 1, snapshot->connectionBlockCapacity);
+    }
+    if (graph->nodeCount > 0) autosave_mark_node(autosave, graph->nodeCount - 1);
+    if (graph->connectionCount > 0) autosave_mark_connection(autosave, graph->connectionCount - 1);
+    autosave->changed = true;
+}
+
+// Brings the snapshot up to date with the graph, copying only dirty blocks.
+static bool refresh(AutosaveSnapshot* snapshot, const Graph* graph) {
+    int nodeBlocks = (graph->nodeCount + BLOCK_SIZE - 1) >> AUTOSAVE_BLOCK_SHIFT;
+    int connectionBlocks = (graph->connectionCount + BLOCK_SIZE - 1) >> AUTOSAVE_BLOCK_SHIFT;
+    int slotCapacity = snapshot->nodeCapacity;
+    if (!grow_items((void**)&snapshot->graph.slots, &slotCapacity, graph->nodeCount, sizeof(NodeSlot)) ||
+        !grow_items((void**)&snapshot->graph.nodes, &snapshot->nodeCapacity, graph->nodeCount, sizeof(Node2D)) ||
+        !grow_items((void**)&snapshot->graph.connections, &snapshot->connectionCapacity, graph->connectionCount,
+                    sizeof(Connection)) ||
+        !grow_blocks(&snapshot->nodeDirty, &snapshot->nodeBlockCapacity, nodeBlocks) ||
+        !grow_blocks(&snapshot->connectionDirty, &snapshot->connectionBlockCapacity, connectionBlocks)) {
+        printf("Autosave: out of memory for a snapshot of %d nodes\n", graph->nodeCount);
+        return false;
+    }
+
+    for (int b = 0; b < nodeBlocks; b++) {
+        if (!snapshot->nodeDirty[b]) continue;
+        int first = b << AUTOSAVE_BLOCK_SHIFT;
+        int count = graph->nodeCount - first < BLOCK_SIZE ? graph->nodeCount - first : BLOCK_SIZE;
+        memcpy(&snapshot->graph.nodes[first], &graph->nodes[first], (size_t)count * sizeof(Node2D));
+        memcpy(&snapshot->graph.slots[first], &graph->slots[first], (size_t)count * sizeof(NodeSlot));
+        snapshot->nodeDirty[b] = 0;
+    }
+    for (int b = 0; b < connectionBlocks; b++) {
+        if (!snapshot->connectionDirty[b]) continue;
+        int first = b << AUTOSAVE_BLOCK_SHIFT;
+        int count = graph->connectionCount - first < BLOCK_SIZE ? graph->connectionCount - first : BLOCK_SIZE;
+        memcpy(&snapshot->graph.connections[first], &graph->connections[first], (size_t)count * sizeof(Connection));
+        snapshot->connectionDirty[b] = 0;
+    }
+    snapshot->graph.nodeCount = graph->nodeCount;
+    snapshot->graph.liveNodeCount = graph->liveNodeCount;
+    snapshot->graph.connectionCount = graph->connectionCount;
+    return true;
+}
+
+// rename() replaces the target atomically on POSIX; Windows needs MoveFileEx for that.
+static bool replace_file(const char* from, const char* to) {
+#ifdef _WIN32
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(from, to) == 0;
+#endif
+}
+
+static int autosave_worker(void* data) {
+    Autosave* autosave = data;
+    char temporaryPath[sizeof(autosave->path) + 4];
+    snprintf(temporaryPath, sizeof(temporaryPath), "%s.tmp", autosave->path);
+
+    SDL_LockMutex(autosave->lock);
+    for (;;) {
+        while (autosave->pending == -1 && !autosave->quit) SDL_WaitCondition(autosave->wake, autosave->lock);
+        if (autosave->pending == -1) break; // quitting with nothing left to write
+        int s = autosave->pending;
+        autosave->pending = -1;
+        autosave->writing = s;
+        SDL_UnlockMutex(autosave->lock);
+
+        // The file is complete before it replaces the previous save, so a crash mid-write
+        // leaves the last good autosave in place.
+        Uint64 start = SDL_GetPerformanceCounter();
+        const Graph* graph = &autosave->snapshots[s].graph;
+        bool ok = graph_file_save(graph, temporaryPath) && replace_file(temporaryPath, autosave->path);
+        float writeMs = (float)elapsed_ms(start);
+        if (!ok) printf("Autosave to %s failed\n", autosave->path);
+        else if (autosave->verbose) {
+            printf("Autosaved %d nodes to %s: write %.1f ms\n", graph->liveNodeCount, autosave->path, writeMs);
+        }
+
+        SDL_LockMutex(autosave->lock);
+        autosave->writing = -1;
+        autosave->failed = !ok;
+        if (ok) {
+            autosave->saves++;
+            autosave->writeMs = writeMs;
+        }
+    }
+    SDL_UnlockMutex(autosave->lock);
+    return 0;
+}
+
+bool autosave_start(Autosave* autosave, const char* path, Uint64 intervalMs) {
+    snprintf(autosave->path, sizeof(autosave->path), "%s", path);
+    autosave->intervalMs = intervalMs;
+    autosave->lastSaveMs = SDL_GetTicks();
+    autosave->lock = SDL_CreateMutex();
+    autosave->wake = SDL_CreateCondition();
+    if (autosave->lock && autosave->wake) {
+        autosave->thread = SDL_CreateThread(autosave_worker, "autosave", autosave);
+    }
+    if (!autosave->thread) {
+        printf("Failed to start autosave: %s\n", SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
+// Refreshes the snapshot the worker is not writing and queues it.
+static void take_snapshot(Autosave* autosave, const Graph* graph) {
+    SDL_LockMutex(autosave->lock);
+    int s = autosave->writing == 0 ? 1 : 0;
+    autosave->pending = -1; // a queued but unstarted save is superseded by this one
+    autosave->failed = false;
+    SDL_UnlockMutex(autosave->lock);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    if (!refresh(&autosave->snapshots[s], graph)) return;
+    autosave->snapshotMs = (float)elapsed_ms(start);
+    autosave->changed = false;
+    autosave->lastSaveMs = SDL_GetTicks();
+
+    SDL_LockMutex(autosave->lock);
+    autosave->pending = s;
+    SDL_SignalCondition(autosave->wake);
+    SDL_UnlockMutex(autosave->lock);
+}
+
+// A failed write leaves the changes it held unsaved, so it counts as a change.
+static bool unsaved(Autosave* autosave) {
+    if (autosave->changed) return true;
+    SDL_LockMutex(autosave->lock);
+    bool failed = autosave->failed;
+    SDL_UnlockMutex(autosave->lock);
+    return failed;
+}
+
+void autosave_update(Autosave* autosave, const Graph* graph) {
+    if (!autosave->thread) return;
+    if (SDL_GetTicks() - autosave->lastSaveMs < autosave->intervalMs) return;
+    if (unsaved(autosave)) take_snapshot(autosave, graph);
+}
+
+void autosave_stats(Autosave* autosave, int* saves, float* snapshotMs, float* writeMs) {
+    if (autosave->lock) SDL_LockMutex(autosave->lock);
+    *saves = autosave->saves;
+    *writeMs = autosave->writeMs;
+    if (autosave->lock) SDL_UnlockMutex(autosave->lock);
+    *snapshotMs = autosave->snapshotMs;
+}
+
+void autosave_destroy(Autosave* autosave, const Graph* graph) {
+    if (autosave->thread) {
+        if (unsaved(autosave)) take_snapshot(autosave, graph);
+        SDL_LockMutex(autosave->lock);
+        autosave->quit = true;
+        SDL_SignalCondition(autosave->wake);
+        SDL_UnlockMutex(autosave->lock);
+        SDL_WaitThread(autosave->thread, NULL);
+    }
+    if (autosave->wake) SDL_DestroyCondition(autosave->wake);
+    if (autosave->lock) SDL_DestroyMutex(autosave->lock);
+    for (int s = 0; s < 2; s++) {
+        AutosaveSnapshot* snapshot = &autosave->snapshots[s];
+        mem_free(snapshot->graph.nodes);
+        mem_free(snapshot->graph.slots);
+        mem_free(snapshot->graph.connections);
+        mem_free(snapshot->nodeDirty);
+        mem_free(snapshot->connectionDirty);
+    }
+    memset(autosave, 0, sizeof(*autosave));
+}
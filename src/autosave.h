@@ -0,0 +1,65 @@
+#ifndef AUTOSAVE_H
+#define AUTOSAVE_H
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+#include "graph.h"
+
+#define AUTOSAVE_BLOCK_SHIFT 10 // nodes and connections are tracked in blocks of 1024
+
+// One copy of the saved state. Laid out as a Graph so graph_file_save can write it; only
+// nodes, slots, connections and the counts are filled in.
+typedef struct {
+    Graph graph;
+    int nodeCapacity, connectionCapacity;
+    unsigned char* nodeDirty;       // blocks changed since this copy was last refreshed
+    unsigned char* connectionDirty;
+    int nodeBlockCapacity, connectionBlockCapacity;
+} AutosaveSnapshot;
+
+// Periodic background save. The main thread refreshes one of two snapshots, copying only
+// the blocks of nodes and connections that changed since that snapshot was last taken, and
+// hands it to a worker thread that writes it to a temporary file and renames it over the
+// target. The other snapshot stays free for the next refresh, so the main thread never
+// waits for a write in progress.
+typedef struct {
+    AutosaveSnapshot snapshots[2];
+    SDL_Thread* thread;
+    SDL_Mutex* lock;
+    SDL_Condition* wake;
+    char path[256];
+    Uint64 intervalMs;
+    Uint64 lastSaveMs;
+    bool changed;    // graph edited since the last snapshot
+    int pending;     // snapshot queued for the worker, -1 if none
+    int writing;     // snapshot the worker is writing, -1 if idle
+    bool failed;     // the last write failed; set by the worker, retried at the next interval
+    bool quit;
+    // Instrumentation, read by the HUD. Write figures are updated by the worker under lock.
+    int saves;
+    float snapshotMs; // last refresh, on the main thread
+    float writeMs;    // last write and rename, on the worker
+    bool verbose;
+} Autosave;
+
+// Starts disabled; marking changes is cheap and allowed before autosave_start.
+void autosave_init(Autosave* autosave);
+// Saves to path every intervalMs while the graph keeps changing. Returns false if the
+// worker could not be started.
+bool autosave_start(Autosave* autosave, const char* path, Uint64 intervalMs);
+// Queues a final save of any unsaved changes, waits for the worker and frees everything.
+void autosave_destroy(Autosave* autosave, const Graph* graph);
+
+// Record an edit of node or connection index, including adds, removals and moves.
+void autosave_mark_node(Autosave* autosave, int index);
+void autosave_mark_connection(Autosave* autosave, int index);
+// Marks everything, e.g. after the graph was replaced.
+void autosave_mark_all(Autosave* autosave, const Graph* graph);
+
+// Call once per main loop iteration. Takes a snapshot and wakes the worker when the
+// interval has passed and there are unsaved changes.
+void autosave_update(Autosave* autosave, const Graph* graph);
+// Completed saves and the durations of the last snapshot and write.
+void autosave_stats(Autosave* autosave, int* saves, float* snapshotMs, float* writeMs);
+
+#endif
@@ -0,0 +1,155 @@
+#include "batch_eval.h"
+#include <stdio.h>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define BATCH_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BATCH_SSE
+#endif
+
+// The vector operations the kernels need. Comparisons give all-ones or all-zero lanes, like
+// the SSE and AVX compares; masking 1 with them gives the 1 or 0 that eval_step returns.
+#if defined(BATCH_AVX)
+typedef __m256 Vector;
+#define VECTOR_WIDTH 8
+#define vector_load _mm256_loadu_ps
+#define vector_store _mm256_storeu_ps
+#define vector_set _mm256_set1_ps
+#define vector_add _mm256_add_ps
+#define vector_sub _mm256_sub_ps
+#define vector_mul _mm256_mul_ps
+#define vector_div _mm256_div_ps
+#define vector_and _mm256_and_ps
+#define vector_or _mm256_or_ps
+#define vector_andnot _mm256_andnot_ps
+#define vector_less(a, b) _mm256_cmp_ps(a, b, _CMP_LT_OQ)
+#define vector_greater(a, b) _mm256_cmp_ps(a, b, _CMP_GT_OQ)
+#define vector_equal(a, b) _mm256_cmp_ps(a, b, _CMP_EQ_OQ)
+#define vector_not_equal(a, b) _mm256_cmp_ps(a, b, _CMP_NEQ_UQ)
+#define vector_unordered(a, b) _mm256_cmp_ps(a, b, _CMP_UNORD_Q)
+#elif defined(BATCH_SSE)
+typedef __m128 Vector;
+#define VECTOR_WIDTH 4
+#define vector_load _mm_loadu_ps
+#define vector_store _mm_storeu_ps
+#define vector_set _mm_set1_ps
+#define vector_add _mm_add_ps
+#define vector_sub _mm_sub_ps
+#define vector_mul _mm_mul_ps
+#define vector_div _mm_div_ps
+#define vector_and _mm_and_ps
+#define vector_or _mm_or_ps
+#define vector_andnot _mm_andnot_ps
+#define vector_less _mm_cmplt_ps
+#define vector_greater _mm_cmpgt_ps
+#define vector_equal _mm_cmpeq_ps
+#define vector_not_equal _mm_cmpneq_ps
+#define vector_unordered _mm_cmpunord_ps
+#endif
+
+#ifdef VECTOR_WIDTH
+// Lanes of x where mask is set, of y elsewhere.
+#define vector_select(mask, x, y) vector_or(vector_and(mask, x), vector_andnot(mask, y))
+#define vector_bool(mask) vector_and(mask, one)
+// Whole vectors first, then the rows left over one at a time. Inputs that an instruction
+// does not use read register 0, and the compiler drops those loads.
+#define KERNEL(vectorExpression, scalarExpression)                                      \
+    for (; i + VECTOR_WIDTH <= rows; i += VECTOR_WIDTH) {                              \
+        Vector a = vector_load(ca + i), b = vector_load(cb + i), c = vector_load(cc + i); \
+        (void)b;                                                                        \
+        (void)c;                                                                        \
+        vector_store(d + i, vectorExpression);                                          \
+    }                                                                                   \
+    for (; i < rows; i++) {                                                             \
+        float a = ca[i], b = cb[i], c = cc[i];                                          \
+        (void)b;                                                                        \
+        (void)c;                                                                        \
+        d[i] = scalarExpression;                                                        \
+    }                                                                                   \
+    break;
+#else
+#define KERNEL(vectorExpression, scalarExpression) \
+    for (; i < rows; i++) {                        \
+        float a = ca[i], b = cb[i], c = cc[i];     \
+        (void)b;                                   \
+        (void)c;                                   \
+        d[i] = scalarExpression;                   \
+    }                                              \
+    break;
+#endif
+
+const char* batch_isa(void) {
+#if defined(BATCH_AVX)
+    return "avx";
+#elif defined(BATCH_SSE)
+    return "sse";
+#else
+    return "scalar";
+#endif
+}
+
+size_t batch_arena_bytes(const BytecodeProgram* program) {
+    return arena_size((size_t)program->registerCount * BATCH_SIZE * sizeof(float));
+}
+
+bool batch_init(BatchEvaluator* batch, const BytecodeProgram* program, Arena* arena) {
+    batch->program = program;
+    batch->columns = arena_alloc(arena, (size_t)program->registerCount * BATCH_SIZE * sizeof(float));
+    if (!batch->columns) {
+        printf("Batch: arena too small for %d columns\n", program->registerCount);
+        return false;
+    }
+    // Constants never change, and the parameters start out at their compiled values.
+    for (int r = 0; r < program->registerCount; r++) {
+        float* column = batch->columns + (size_t)r * BATCH_SIZE;
+        float value = r < program->constantCount + program->parameterCount ? program->registers[r] : 0.0f;
+        for (int i = 0; i < BATCH_SIZE; i++) column[i] = value;
+    }
+    return true;
+}
+
+// One instruction over the first rows rows; the same arithmetic as bytecode_run.
+static void run_kernel(const BytecodeInstruction* ip, float* columns, int rows) {
+    const float* ca = columns + (size_t)ip->a * BATCH_SIZE;
+    const float* cb = columns + (size_t)ip->b * BATCH_SIZE;
+    const float* cc = columns + (size_t)ip->c * BATCH_SIZE;
+    float* d = columns + (size_t)ip->dst * BATCH_SIZE;
+    int i = 0;
+#ifdef VECTOR_WIDTH
+    const Vector zero = vector_set(0.0f), one = vector_set(1.0f);
+    (void)zero;
+    (void)one;
+#endif
+    switch (ip->op) {
+    case BYTECODE_MOVE: KERNEL(a, a)
+    case BYTECODE_ADD: KERNEL(vector_add(a, b), a + b)
+    case BYTECODE_SUBTRACT: KERNEL(vector_sub(a, b), a - b)
+    case BYTECODE_MULTIPLY: KERNEL(vector_mul(a, b), a * b)
+    case BYTECODE_DIVIDE: KERNEL(vector_div(a, b), a / b)
+    case BYTECODE_MIN:
+        KERNEL(vector_select(vector_or(vector_less(a, b), vector_unordered(b, b)), a, b), eval_min(a, b))
+    case BYTECODE_MAX:
+        KERNEL(vector_select(vector_or(vector_greater(a, b), vector_unordered(b, b)), a, b), eval_max(a, b))
+    case BYTECODE_LESS: KERNEL(vector_bool(vector_less(a, b)), a < b)
+    case BYTECODE_GREATER: KERNEL(vector_bool(vector_greater(a, b)), a > b)
+    case BYTECODE_EQUAL: KERNEL(vector_bool(vector_equal(a, b)), a == b)
+    case BYTECODE_AND:
+        KERNEL(vector_bool(vector_and(vector_not_equal(a, zero), vector_not_equal(b, zero))),
+               a != 0.0f && b != 0.0f)
+    case BYTECODE_OR:
+        KERNEL(vector_bool(vector_or(vector_not_equal(a, zero), vector_not_equal(b, zero))),
+               a != 0.0f || b != 0.0f)
+    case BYTECODE_NOT: KERNEL(vector_bool(vector_equal(a, zero)), a == 0.0f)
+    case BYTECODE_SELECT: KERNEL(vector_select(vector_not_equal(a, zero), b, c), a != 0.0f ? b : c)
+    default: break;
+    }
+}
+
+void batch_run(BatchEvaluator* batch, int rows) {
+    if (rows > BATCH_SIZE) rows = BATCH_SIZE;
+    for (const BytecodeInstruction* ip = batch->program->code; ip->op != BYTECODE_END; ip++) {
+        run_kernel(ip, batch->columns, rows);
+    }
+}
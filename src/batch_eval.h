@@ -0,0 +1,41 @@
+#ifndef BATCH_EVAL_H
+#define BATCH_EVAL_H
+
+#include <stdbool.h>
+#include "arena.h"
+#include "bytecode.h"
+
+#define BATCH_SIZE 1024 // rows per column
+
+// Runs a bytecode program over columns of rows instead of single values: every register is
+// a column of BATCH_SIZE floats, and each instruction is one kernel over the whole column,
+// vectorized with AVX or SSE when the compiler targets them (e.g. -mavx) and plain C
+// otherwise. The instruction dispatch is paid once per column rather than once per row, so
+// graphs serve as pipelines over large inputs. Results match bytecode_run row by row, bit
+// for bit.
+typedef struct {
+    const BytecodeProgram* program;
+    float* columns; // registerCount columns, register r at columns + r * BATCH_SIZE
+} BatchEvaluator;
+
+// Space batch_init takes from an arena for the program.
+size_t batch_arena_bytes(const BytecodeProgram* program);
+// Takes the columns from the arena and fills the constant ones. The program must outlive
+// the evaluator, and the columns are released with the arena. Returns false if the arena is
+// too small.
+bool batch_init(BatchEvaluator* batch, const BytecodeProgram* program, Arena* arena);
+
+// The caller writes a batch's rows of each parameter here before running it.
+static inline float* batch_input(BatchEvaluator* batch, int parameter) {
+    return batch->columns + (size_t)batch->program->parameterRegisters[parameter] * BATCH_SIZE;
+}
+// Evaluates the first rows rows, at most BATCH_SIZE, of every column.
+void batch_run(BatchEvaluator* batch, int rows);
+static inline const float* batch_output(const BatchEvaluator* batch, int output) {
+    return batch->columns + (size_t)batch->program->outputRegisters[output] * BATCH_SIZE;
+}
+
+// Name of the code path the kernels were compiled with: "avx", "sse" or "scalar".
+const char* batch_isa(void);
+
+#endif
@@ -0,0 +1,296 @@
+#include "bytecode.h"
+#include "mem.h"
+#include <stdio.h>
+#include <string.h>
+
+// Labels as values, a GCC extension that Clang shares: each handler jumps straight to the
+// next one instead of returning to a switch, one indirect branch per instruction. Define
+// BYTECODE_SWITCH_DISPATCH to compare against the portable loop.
+#if defined(__GNUC__) && !defined(BYTECODE_SWITCH_DISPATCH)
+#define BYTECODE_COMPUTED_GOTO
+#endif
+
+static const BytecodeOp opcodes[NODE_TYPE_COUNT] = {
+    [NODE_VARIABLE] = BYTECODE_MOVE,
+    [NODE_TOGGLE] = BYTECODE_END, // never executed: a Toggle is a constant or a parameter
+    [NODE_ADD] = BYTECODE_ADD,
+    [NODE_SUBTRACT] = BYTECODE_SUBTRACT,
+    [NODE_MULTIPLY] = BYTECODE_MULTIPLY,
+    [NODE_DIVIDE] = BYTECODE_DIVIDE,
+    [NODE_MIN] = BYTECODE_MIN,
+    [NODE_MAX] = BYTECODE_MAX,
+    [NODE_LESS] = BYTECODE_LESS,
+    [NODE_GREATER] = BYTECODE_GREATER,
+    [NODE_EQUAL] = BYTECODE_EQUAL,
+    [NODE_AND] = BYTECODE_AND,
+    [NODE_OR] = BYTECODE_OR,
+    [NODE_NOT] = BYTECODE_NOT,
+    [NODE_SELECT] = BYTECODE_SELECT,
+};
+
+// What the compiler knows about one plan step, indexed by rank.
+typedef struct {
+    int reg;     // register holding the node's value, -1 while it has none
+    int lastUse; // last instruction reading the value, -1 if none does
+    bool constant, parameter, output, live, read;
+} StepInfo;
+
+typedef struct {
+    Evaluator* eval;
+    const Graph* graph;
+    StepInfo* info;
+    float* folded;      // constant values by node slot, as eval_step reads them
+    int* freeRegisters; // working registers whose value is dead
+    int freeCount;
+} Compiler;
+
+static StepInfo* input_info(Compiler* compiler, int node) {
+    return node == -1 ? NULL : &compiler->info[compiler->eval->rank[node]];
+}
+
+static bool mark_parameters(Compiler* compiler, BytecodeProgram* program, const int* parameters, int parameterCount) {
+    const Graph* graph = compiler->graph;
+    for (int i = 0; i < parameterCount; i++) {
+        int node = parameters[i];
+        bool source = graph_node_alive(graph, node) && eval_has_value(compiler->eval, node) &&
+                      (graph->nodes[node].type == NODE_TOGGLE ||
+                       (graph->nodes[node].type == NODE_VARIABLE && !graph_input_used(graph, node, 0)));
+        if (!source) {
+            printf("Bytecode: node %d cannot be a parameter\n", node);
+            return false;
+        }
+        compiler->info[compiler->eval->rank[node]].parameter = true;
+    }
+    program->parameterCount = parameterCount;
+    return true;
+}
+
+// In plan order every input is decided before the nodes reading it, so one pass folds whole
+// constant subgraphs.
+static void fold_constants(Compiler* compiler, BytecodeProgram* program) {
+    const Evaluator* eval = compiler->eval;
+    for (int k = 0; k < eval->stepCount; k++) {
+        const EvalStep* step = &eval->steps[k];
+        StepInfo* info = &compiler->info[k];
+        info->reg = -1;
+        info->lastUse = -1;
+        bool constant = !info->parameter;
+        for (int s = 0; s < NODE_MAX_INPUTS; s++) {
+            StepInfo* input = input_info(compiler, step->inputs[s]);
+            if (!input) continue;
+            input->read = true;
+            if (!input->constant) constant = false;
+        }
+        if (!constant) continue;
+        info->constant = true;
+        compiler->folded[step->node] = eval_step(step, compiler->folded, compiler->graph->nodes);
+        if (step->type != NODE_VARIABLE && step->type != NODE_TOGGLE) program->foldedCount++;
+    }
+}
+
+static bool mark_outputs(Compiler* compiler, BytecodeProgram* program, const int* outputs, int outputCount) {
+    const Evaluator* eval = compiler->eval;
+    if (outputCount == 0) {
+        for (int k = 0; k < eval->stepCount; k++) {
+            if (!compiler->info[k].read) program->outputNodes[outputCount++] = eval->steps[k].node;
+        }
+    } else {
+        for (int i = 0; i < outputCount; i++) {
+            if (!graph_node_alive(compiler->graph, outputs[i]) || !eval_has_value(eval, outputs[i])) {
+                printf("Bytecode: node %d has no value to output\n", outputs[i]);
+                return false;
+            }
+            program->outputNodes[i] = outputs[i];
+        }
+    }
+    program->outputCount = outputCount;
+    for (int i = 0; i < outputCount; i++) compiler->info[eval->rank[program->outputNodes[i]]].output = true;
+    return true;
+}
+
+// Walks back from the outputs; folded nodes need none of their inputs.
+static void mark_live(Compiler* compiler, BytecodeProgram* program) {
+    const Evaluator* eval = compiler->eval;
+    for (int k = eval->stepCount - 1; k >= 0; k--) {
+        StepInfo* info = &compiler->info[k];
+        info->live = info->live || info->output;
+        if (!info->live) {
+            program->deadCount++;
+            continue;
+        }
+        if (info->constant) continue;
+        for (int s = 0; s < NODE_MAX_INPUTS; s++) {
+            StepInfo* input = input_info(compiler, eval->steps[k].inputs[s]);
+            if (input) input->live = true;
+        }
+    }
+}
+
+static bool emitted(const StepInfo* info) {
+    return info->live && !info->constant && !info->parameter;
+}
+
+// Constants that something reads, then the parameters, each in a register of its own.
+static void assign_fixed_registers(Compiler* compiler, BytecodeProgram* program) {
+    const Evaluator* eval = compiler->eval;
+    program->registers[0] = 0.0f;
+    program->constantCount = 1;
+    for (int k = 0; k < eval->stepCount; k++) {
+        StepInfo* info = &compiler->info[k];
+        if (!emitted(info) && !info->output) continue;
+        for (int s = -1; s < NODE_MAX_INPUTS; s++) {
+            int node = s == -1 ? eval->steps[k].node : eval->steps[k].inputs[s];
+            StepInfo* value = s == -1 ? info : input_info(compiler, node);
+            if (!value || !value->constant || value->reg != -1) continue;
+            value->reg = program->constantCount++;
+            program->registers[value->reg] = compiler->folded[node];
+        }
+    }
+    int parameter = 0;
+    for (int k = 0; k < eval->stepCount; k++) {
+        StepInfo* info = &compiler->info[k];
+        if (!info->parameter) continue;
+        info->reg = program->constantCount + parameter++;
+        program->registers[info->reg] = eval_step(&eval->steps[k], compiler->folded, compiler->graph->nodes);
+    }
+}
+
+// One instruction per remaining node, in plan order. A working register is handed out again
+// after the last instruction reading it, so the register file stays about as wide as the
+// graph rather than as long.
+static void emit_code(Compiler* compiler, BytecodeProgram* program) {
+    const Evaluator* eval = compiler->eval;
+    int instruction = 0;
+    for (int k = 0; k < eval->stepCount; k++) {
+        if (!emitted(&compiler->info[k])) continue;
+        for (int s = 0; s < NODE_MAX_INPUTS; s++) {
+            StepInfo* input = input_info(compiler, eval->steps[k].inputs[s]);
+            if (input) input->lastUse = instruction;
+        }
+        instruction++;
+    }
+
+    int nextRegister = program->constantCount + program->parameterCount;
+    instruction = 0;
+    for (int k = 0; k < eval->stepCount; k++) {
+        StepInfo* info = &compiler->info[k];
+        if (!emitted(info)) continue;
+        const EvalStep* step = &eval->steps[k];
+        int operands[NODE_MAX_INPUTS];
+        for (int s = 0; s < NODE_MAX_INPUTS; s++) {
+            StepInfo* input = input_info(compiler, step->inputs[s]);
+            operands[s] = input ? input->reg : 0;
+            // Reading happens before writing, so the result may reuse an input's register.
+            if (input && input->lastUse == instruction && !input->constant && !input->parameter && !input->output) {
+                input->lastUse = -1; // freed once even if read through two inputs
+                compiler->freeRegisters[compiler->freeCount++] = input->reg;
+            }
+        }
+        info->reg = compiler->freeCount > 0 ? compiler->freeRegisters[--compiler->freeCount] : nextRegister++;
+        program->code[instruction++] =
+            (BytecodeInstruction){(uint8_t)opcodes[step->type], info->reg, operands[0], operands[1], operands[2]};
+    }
+    program->code[instruction] = (BytecodeInstruction){BYTECODE_END, 0, 0, 0, 0};
+    program->codeLength = instruction;
+    program->registerCount = nextRegister;
+}
+
+bool bytecode_compile(BytecodeProgram* program, Evaluator* eval, const Graph* graph, const int* parameters,
+                      int parameterCount, const int* outputs, int outputCount) {
+    memset(program, 0, sizeof(*program));
+    if (eval->planDirty && !eval_compile(eval, graph)) return false;
+    int steps = eval->stepCount;
+    Compiler compiler = {eval, graph, NULL, NULL, NULL, 0};
+    compiler.info = mem_calloc((size_t)steps + 1, sizeof(StepInfo));
+    compiler.folded = mem_alloc(((size_t)graph->nodeCount + 1) * sizeof(float));
+    compiler.freeRegisters = mem_alloc(((size_t)steps + 1) * sizeof(int));
+    // Each step gets at most one register, constant, parameter or working, plus the zero.
+    program->code = mem_alloc(((size_t)steps + 1) * sizeof(BytecodeInstruction));
+    program->registers = mem_alloc(((size_t)steps + 1) * sizeof(float));
+    program->parameterRegisters = mem_alloc(((size_t)parameterCount + 1) * sizeof(int));
+    int outputCapacity = outputCount > 0 ? outputCount : steps;
+    program->outputRegisters = mem_alloc(((size_t)outputCapacity + 1) * sizeof(int));
+    program->outputNodes = mem_alloc(((size_t)outputCapacity + 1) * sizeof(int));
+
+    bool ok = compiler.info && compiler.folded && compiler.freeRegisters && program->code && program->registers &&
+              program->parameterRegisters && program->outputRegisters && program->outputNodes;
+    if (!ok) printf("Bytecode: out of memory compiling %d nodes\n", steps);
+    ok = ok && mark_parameters(&compiler, program, parameters, parameterCount);
+    if (ok) {
+        fold_constants(&compiler, program);
+        ok = mark_outputs(&compiler, program, outputs, outputCount);
+    }
+    if (ok) {
+        mark_live(&compiler, program);
+        assign_fixed_registers(&compiler, program);
+        emit_code(&compiler, program);
+        for (int i = 0; i < parameterCount; i++) program->parameterRegisters[i] = compiler.info[eval->rank[parameters[i]]].reg;
+        for (int i = 0; i < program->outputCount; i++) {
+            program->outputRegisters[i] = compiler.info[eval->rank[program->outputNodes[i]]].reg;
+        }
+    }
+    mem_free(compiler.info);
+    mem_free(compiler.folded);
+    mem_free(compiler.freeRegisters);
+    if (!ok) bytecode_destroy(program);
+    return ok;
+}
+
+void bytecode_destroy(BytecodeProgram* program) {
+    mem_free(program->code);
+    mem_free(program->registers);
+    mem_free(program->parameterRegisters);
+    mem_free(program->outputRegisters);
+    mem_free(program->outputNodes);
+    memset(program, 0, sizeof(*program));
+}
+
+// The same arithmetic as eval_step, so both evaluators agree to the bit.
+#define OPERATIONS(X)                                        \
+    X(BYTECODE_MOVE, r[ip->a])                               \
+    X(BYTECODE_ADD, r[ip->a] + r[ip->b])                     \
+    X(BYTECODE_SUBTRACT, r[ip->a] - r[ip->b])                \
+    X(BYTECODE_MULTIPLY, r[ip->a] * r[ip->b])                \
+    X(BYTECODE_DIVIDE, r[ip->a] / r[ip->b])                  \
+    X(BYTECODE_MIN, eval_min(r[ip->a], r[ip->b]))            \
+    X(BYTECODE_MAX, eval_max(r[ip->a], r[ip->b]))            \
+    X(BYTECODE_LESS, r[ip->a] < r[ip->b])                    \
+    X(BYTECODE_GREATER, r[ip->a] > r[ip->b])                 \
+    X(BYTECODE_EQUAL, r[ip->a] == r[ip->b])                  \
+    X(BYTECODE_AND, r[ip->a] != 0.0f && r[ip->b] != 0.0f)    \
+    X(BYTECODE_OR, r[ip->a] != 0.0f || r[ip->b] != 0.0f)     \
+    X(BYTECODE_NOT, r[ip->a] == 0.0f)                        \
+    X(BYTECODE_SELECT, r[ip->a] != 0.0f ? r[ip->b] : r[ip->c])
+
+void bytecode_run(BytecodeProgram* program) {
+    float* r = program->registers;
+    const BytecodeInstruction* ip = program->code;
+#ifdef BYTECODE_COMPUTED_GOTO
+#define LABEL(code, expression) [code] = &&label_##code,
+#define HANDLER(code, expression)  \
+    label_##code:                  \
+    r[ip->dst] = (expression);     \
+    ip++;                          \
+    goto *labels[ip->op];
+    static void* const labels[BYTECODE_OP_COUNT] = {[BYTECODE_END] = &&label_end, OPERATIONS(LABEL)};
+    goto *labels[ip->op];
+    OPERATIONS(HANDLER)
+label_end:
+    return;
+#undef LABEL
+#undef HANDLER
+#else
+#define CASE(code, expression)     \
+    case code:                     \
+        r[ip->dst] = (expression); \
+        break;
+    for (;; ip++) {
+        switch (ip->op) {
+        OPERATIONS(CASE)
+        default:
+            return;
+        }
+    }
+#undef CASE
+#endif
+}
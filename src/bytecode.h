@@ -0,0 +1,71 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "eval.h"
+
+typedef enum {
+    BYTECODE_END,
+    BYTECODE_MOVE, // a Variable fed by its input
+    BYTECODE_ADD,
+    BYTECODE_SUBTRACT,
+    BYTECODE_MULTIPLY,
+    BYTECODE_DIVIDE,
+    BYTECODE_MIN,
+    BYTECODE_MAX,
+    BYTECODE_LESS,
+    BYTECODE_GREATER,
+    BYTECODE_EQUAL,
+    BYTECODE_AND,
+    BYTECODE_OR,
+    BYTECODE_NOT,
+    BYTECODE_SELECT,
+    BYTECODE_OP_COUNT
+} BytecodeOp;
+
+// registers[dst] = op(registers[a], registers[b], registers[c]); unused operands are 0.
+typedef struct {
+    uint8_t op;
+    int32_t dst, a, b, c;
+} BytecodeInstruction;
+
+// A graph lowered for repeated evaluation. Registers [0, constantCount) hold constants,
+// register 0 being the 0 that open inputs read; the parameters follow, then the working
+// registers of the instructions, which are reused once the value in them is dead.
+//
+// Compiling folds every node that does not depend on a parameter into a constant and drops
+// the nodes that no output depends on, so a run executes only the instructions between the
+// parameters and the outputs, one flat array of them in plan order.
+typedef struct {
+    BytecodeInstruction* code; // ends with BYTECODE_END
+    int codeLength;            // instructions, not counting the END
+    float* registers;
+    int registerCount;
+    int constantCount;
+    int* parameterRegisters;
+    int parameterCount;
+    int* outputRegisters;
+    int* outputNodes; // node slot of each output
+    int outputCount;
+    int foldedCount; // nodes computed at compile time
+    int deadCount;   // nodes no output depends on
+} BytecodeProgram;
+
+// Lowers the evaluator's plan for the graph, compiling it first if needed. Parameters must be
+// Variables or Toggles without an input connection; their current value is the initial one.
+// With no outputs given, every node in the plan that no other node reads is an output. Nodes
+// on a cycle cannot be outputs. Returns false on bad arguments or when memory runs out.
+bool bytecode_compile(BytecodeProgram* program, Evaluator* eval, const Graph* graph, const int* parameters,
+                      int parameterCount, const int* outputs, int outputCount);
+void bytecode_destroy(BytecodeProgram* program);
+
+static inline void bytecode_set_parameter(BytecodeProgram* program, int parameter, float value) {
+    program->registers[program->parameterRegisters[parameter]] = value;
+}
+void bytecode_run(BytecodeProgram* program);
+static inline float bytecode_output(const BytecodeProgram* program, int output) {
+    return program->registers[program->outputRegisters[output]];
+}
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+// Screen position of a world point p is p * scale - (x, y).
+typedef struct {
+    float x, y;
+    float scale;
+} Camera;
+
+#endif
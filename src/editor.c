@@ -0,0 +1,703 @@
+#include "editor.h"
+#include "graph_file.h"
+#include "graph_json.h"
+#include "mem.h"
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+static void editor_log(const Editor* editor, const char* format, ...) {
+    if (!editor->verbose) return;
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+// Rasterizes the printable ASCII range once into the shared glyph atlas.
+static bool bake_font_atlas(TextAtlas* atlas, TTF_Font* font) {
+    if (!text_atlas_begin(atlas, 512, 512, (float)TTF_GetFontHeight(font))) return false;
+    SDL_Color textColor = {255, 255, 255, 255};
+    for (Uint32 c = 32; c < 127; c++) {
+        int advance = 0;
+        TTF_GetGlyphMetrics(font, c, NULL, NULL, NULL, NULL, &advance);
+        SDL_Surface* glyphSurface = TTF_RenderGlyph_Blended(font, c, textColor);
+        SDL_Surface* convertedSurface = glyphSurface ? SDL_ConvertSurface(glyphSurface, SDL_PIXELFORMAT_RGBA32) : NULL;
+        if (convertedSurface) {
+            // RGBA32 is byte ordered R, G, B, A, so coverage is the fourth byte of each pixel.
+            text_atlas_add_glyph(atlas, (int)c, (const unsigned char*)convertedSurface->pixels + 3,
+                                 convertedSurface->w, convertedSurface->h, convertedSurface->pitch, 4,
+                                 0.0f, 0.0f, (float)advance);
+            SDL_DestroySurface(convertedSurface);
+        } else {
+            text_atlas_add_glyph(atlas, (int)c, NULL, 0, 0, 0, 0, 0.0f, 0.0f, (float)advance);
+        }
+        if (glyphSurface) SDL_DestroySurface(glyphSurface);
+    }
+    text_atlas_end(atlas);
+    return true;
+}
+
+bool editor_init(Editor* editor, TTF_Font* font, float viewWidth, float viewHeight) {
+    memset(editor, 0, sizeof(*editor));
+    editor->camera = (Camera){0.0f, 0.0f, 1.0f};
+    editor->viewWidth = viewWidth;
+    editor->viewHeight = viewHeight;
+    editor->draggedNode = -1;
+    editor->connectingNode = -1;
+    editor->gridSnapping = true;
+    editor->dirty = true;
+    autosave_init(&editor->autosave);
+
+    if (!graph_init(&editor->graph)) {
+        printf("Failed to allocate graph storage\n");
+        return false;
+    }
+    if (!hit_test_init(&editor->hitTest)) {
+        printf("Failed to create spatial index\n");
+        return false;
+    }
+    if (!undo_init(&editor->undo, UNDO_HISTORY_BYTES)) return false;
+    if (!arena_init(&editor->frame, FRAME_SCRATCH_BYTES)) {
+        printf("Failed to allocate frame scratch memory\n");
+        return false;
+    }
+    eval_init(&editor->eval);
+    task_pool_init(&editor->pool, 0);
+    editor->eval.pool = &editor->pool;
+    if (!bake_font_atlas(&editor->atlas, font)) {
+        printf("Failed to build glyph atlas\n");
+        return false;
+    }
+    if (!stream_buffer_init(&editor->stream, VERTEX_STREAM_BYTES, STREAM_PERSISTENT)) {
+        printf("Failed to create vertex stream\n");
+        return false;
+    }
+    if (!node_batch_init(&editor->nodeBatch)) {
+        printf("Failed to create node batch renderer\n");
+        return false;
+    }
+    if (!wire_batch_init(&editor->wires)) {
+        printf("Failed to create connection renderer\n");
+        return false;
+    }
+    if (!text_batch_init(&editor->labels)) {
+        printf("Failed to create text renderer\n");
+        return false;
+    }
+    if (!hud_init(&editor->hud)) {
+        printf("Failed to create HUD\n");
+        return false;
+    }
+    return true;
+}
+
+void editor_destroy(Editor* editor) {
+    autosave_destroy(&editor->autosave, &editor->graph);
+    hud_destroy(&editor->hud);
+    text_batch_destroy(&editor->labels);
+    text_atlas_destroy(&editor->atlas);
+    node_batch_destroy(&editor->nodeBatch);
+    wire_batch_destroy(&editor->wires);
+    stream_buffer_destroy(&editor->stream);
+    hit_test_destroy(&editor->hitTest);
+    undo_destroy(&editor->undo);
+    arena_destroy(&editor->frame);
+    eval_destroy(&editor->eval);
+    task_pool_destroy(&editor->pool);
+    graph_destroy(&editor->graph);
+}
+
+static void record_node(Editor* editor, UndoOp op, int node) {
+    if (!undo_recording(&editor->undo)) return;
+    const Node2D* n = &editor->graph.nodes[node];
+    UndoItem item = {.op = op, .node = node, .toNode = -1, .x = n->x, .y = n->y, .width = n->width,
+                     .height = n->height, .type = n->type, .value = n->value};
+    memcpy(item.name, n->name, sizeof(item.name));
+    undo_record(&editor->undo, &item);
+}
+
+static void record_connection(Editor* editor, UndoOp op, int fromNode, int toNode, int toSlot) {
+    if (!undo_recording(&editor->undo)) return;
+    UndoItem item = {.op = op, .node = fromNode, .toNode = toNode, .toSlot = toSlot};
+    undo_record(&editor->undo, &item);
+}
+
+// Pushes the current endpoints of connections[index] to the wire renderer and the picker.
+static void sync_connection(Editor* editor, int index) {
+    const Graph* graph = &editor->graph;
+    const Node2D* from = &graph->nodes[graph->connections[index].fromNode];
+    const Node2D* to = &graph->nodes[graph->connections[index].toNode];
+    float toY = to->inputY[graph->connections[index].toSlot];
+    wire_batch_set(&editor->wires, index, from->outputX, from->outputY, to->inputX, toY);
+    hit_test_update_wire(&editor->hitTest, graph->nodes, graph->connections, index);
+    autosave_mark_connection(&editor->autosave, index);
+}
+
+// Re-syncs the node's own bounds and every wire attached to it after it moved.
+static void sync_node(Editor* editor, int node) {
+    Graph* graph = &editor->graph;
+    node_update_slots(&graph->nodes[node]);
+    hit_test_update_node(&editor->hitTest, graph->nodes, node);
+    autosave_mark_node(&editor->autosave, node);
+    for (int c = graph_first_out(graph, node); c != -1; c = graph_next_out(graph, c)) sync_connection(editor, c);
+    for (int c = graph_first_in(graph, node); c != -1; c = graph_next_in(graph, c)) sync_connection(editor, c);
+}
+
+int editor_add_node(Editor* editor, NodeType type, float x, float y, const char* name) {
+    int i = graph_add_node(&editor->graph, x, y, name);
+    if (i != -1) {
+        editor->graph.nodes[i].type = type;
+        node_update_slots(&editor->graph.nodes[i]);
+        eval_mark_structure(&editor->eval);
+        eval_mark_node(&editor->eval, i);
+        hit_test_update_node(&editor->hitTest, editor->graph.nodes, i);
+        autosave_mark_node(&editor->autosave, i);
+        record_node(editor, UNDO_ADD_NODE, i);
+        editor->dirty = true;
+    }
+    return i;
+}
+
+int editor_connect(Editor* editor, int fromNode, int toNode, int toSlot) {
+    Graph* graph = &editor->graph;
+    if (!eval_types_match(&graph->nodes[fromNode], &graph->nodes[toNode], toSlot)) return -1;
+    if (graph_input_used(graph, toNode, toSlot)) return -1;
+    int c = graph_add_connection(graph, fromNode, toNode, toSlot);
+    if (c != -1) {
+        sync_connection(editor, c);
+        record_connection(editor, UNDO_CONNECT, fromNode, toNode, toSlot);
+        eval_mark_structure(&editor->eval);
+        eval_mark_node(&editor->eval, toNode);
+        editor->dirty = true;
+    }
+    return c;
+}
+
+// Removes connections[index]; the connection swapped into its place is re-synced.
+void editor_remove_connection(Editor* editor, int index) {
+    Graph* graph = &editor->graph;
+    const Connection* removed = &graph->connections[index];
+    record_connection(editor, UNDO_DISCONNECT, removed->fromNode, removed->toNode, removed->toSlot);
+    eval_mark_structure(&editor->eval);
+    eval_mark_node(&editor->eval, removed->toNode);
+    if (graph_remove_connection(graph, index)) sync_connection(editor, index);
+    wire_batch_truncate(&editor->wires, graph->connectionCount);
+    hit_test_remove_wire(&editor->hitTest, graph->connectionCount);
+    autosave_mark_connection(&editor->autosave, graph->connectionCount);
+    editor->dirty = true;
+}
+
+void editor_delete_nodes(Editor* editor, const int* indices, int count) {
+    Graph* graph = &editor->graph;
+    for (int k = 0; k < count; k++) {
+        int node = indices[k];
+        if (!graph_node_alive(graph, node)) continue;
+        int c;
+        while ((c = graph_first_out(graph, node)) != -1) editor_remove_connection(editor, c);
+        while ((c = graph_first_in(graph, node)) != -1) editor_remove_connection(editor, c);
+        record_node(editor, UNDO_REMOVE_NODE, node);
+        hit_test_remove_node(&editor->hitTest, node);
+        graph_remove_node(graph, node);
+        eval_mark_structure(&editor->eval);
+        autosave_mark_node(&editor->autosave, node);
+        if (editor->draggedNode == node) editor->draggedNode = -1;
+        if (editor->connectingNode == node) editor->connectingNode = -1;
+        editor->dirty = true;
+    }
+}
+
+void editor_set_value(Editor* editor, int node, float value) {
+    Node2D* n = &editor->graph.nodes[node];
+    if (memcmp(&n->value, &value, sizeof(value)) == 0) return; // -0 over 0 is a change
+    if (undo_recording(&editor->undo)) {
+        UndoItem item = {.op = UNDO_SET_VALUE, .node = node, .value = n->value, .toValue = value};
+        undo_record(&editor->undo, &item);
+    }
+    n->value = value;
+    eval_mark_node(&editor->eval, node);
+    autosave_mark_node(&editor->autosave, node);
+    editor->dirty = true;
+}
+
+// Performs one recorded edit, or its inverse when undoing. False if the graph does not match
+// the history, which only happens after edits that were not recorded.
+static bool apply_item(Editor* editor, const UndoItem* item, bool inverse) {
+    Graph* graph = &editor->graph;
+    UndoOp op = item->op;
+    if (inverse) {
+        if (op == UNDO_ADD_NODE) op = UNDO_REMOVE_NODE;
+        else if (op == UNDO_REMOVE_NODE) op = UNDO_ADD_NODE;
+        else if (op == UNDO_CONNECT) op = UNDO_DISCONNECT;
+        else if (op == UNDO_DISCONNECT) op = UNDO_CONNECT;
+    }
+    switch (op) {
+    case UNDO_ADD_NODE: {
+        int i = graph_restore_node(graph, item->node, item->x, item->y, item->name);
+        if (i == -1) return false;
+        graph->nodes[i].width = item->width;
+        graph->nodes[i].height = item->height;
+        graph->nodes[i].type = item->type;
+        graph->nodes[i].value = item->value;
+        node_update_slots(&graph->nodes[i]);
+        eval_mark_structure(&editor->eval);
+        eval_mark_node(&editor->eval, i);
+        hit_test_update_node(&editor->hitTest, graph->nodes, i);
+        autosave_mark_node(&editor->autosave, i);
+        editor->dirty = true;
+        return true;
+    }
+    case UNDO_REMOVE_NODE:
+        if (!graph_node_alive(graph, item->node)) return false;
+        editor_delete_nodes(editor, &item->node, 1);
+        return true;
+    case UNDO_CONNECT:
+        return graph_node_alive(graph, item->node) && graph_node_alive(graph, item->toNode) &&
+               editor_connect(editor, item->node, item->toNode, item->toSlot) != -1;
+    case UNDO_DISCONNECT: {
+        // An input holds a single connection, so a walk over the node's few inputs finds it.
+        if (!graph_node_alive(graph, item->toNode)) return false;
+        int c = graph_input_connection(graph, item->toNode, item->toSlot);
+        if (c == -1 || graph->connections[c].fromNode != item->node) return false;
+        editor_remove_connection(editor, c);
+        return true;
+    }
+    case UNDO_MOVE:
+        if (!graph_node_alive(graph, item->node)) return false;
+        graph->nodes[item->node].x = inverse ? item->x : item->toX;
+        graph->nodes[item->node].y = inverse ? item->y : item->toY;
+        sync_node(editor, item->node);
+        editor->dirty = true;
+        return true;
+    case UNDO_SET_VALUE:
+        if (!graph_node_alive(graph, item->node)) return false;
+        editor_set_value(editor, item->node, inverse ? item->value : item->toValue);
+        return true;
+    }
+    return false;
+}
+
+// Undoes or redoes one journal entry. Replayed edits are not recorded again: no entry is open.
+static bool replay_entry(Editor* editor, bool undo) {
+    UndoReplay replay;
+    if (!(undo ? undo_step_back(&editor->undo, &replay) : undo_step_forward(&editor->undo, &replay))) return false;
+    UndoItem item;
+    int count = 0;
+    while (undo_next_item(&editor->undo, &replay, &item)) {
+        if (!apply_item(editor, &item, undo)) {
+            printf("Undo history does not match the graph, history cleared\n");
+            undo_clear(&editor->undo);
+            return false;
+        }
+        count++;
+    }
+    editor_log(editor, "%s %d edits\n", undo ? "Undid" : "Redid", count);
+    return true;
+}
+
+bool editor_undo(Editor* editor) {
+    return replay_entry(editor, true);
+}
+
+bool editor_redo(Editor* editor) {
+    return replay_entry(editor, false);
+}
+
+// Zooms by step around the pointer, keeping the world point under it fixed.
+static void zoom_at_pointer(Editor* editor, float step) {
+    Camera* camera = &editor->camera;
+    float worldX = (editor->mouseX + camera->x) / camera->scale;
+    float worldY = (editor->mouseY + camera->y) / camera->scale;
+    float oldScale = camera->scale;
+    // Multiplicative, so a wheel notch feels the same at every zoom level.
+    camera->scale = fmaxf(fminf(camera->scale * expf(step), ZOOM_MAX), ZOOM_MIN);
+    if (camera->scale != oldScale) {
+        camera->x = worldX * camera->scale - editor->mouseX;
+        camera->y = worldY * camera->scale - editor->mouseY;
+        editor_log(editor, "Zoomed to scale %.2f\n", camera->scale);
+        editor->dirty = true;
+    }
+}
+
+static float snap(const Editor* editor, float v) {
+    return editor->gridSnapping ? roundf(v / GRID_SIZE) * GRID_SIZE : v;
+}
+
+static void handle_button_down(Editor* editor, const SDL_MouseButtonEvent* button) {
+    Graph* graph = &editor->graph;
+    const Camera* camera = &editor->camera;
+    float worldX = (button->x + camera->x) / camera->scale;
+    float worldY = (button->y + camera->y) / camera->scale;
+
+    if (button->button == SDL_BUTTON_LEFT) {
+        // Slots that are not drawn cannot be grabbed; their pick radius would cover whole nodes.
+        int i = -1;
+        if (lod_level(camera->scale) < LOD_NO_SLOTS) {
+            i = hit_test_output_slot(&editor->hitTest, graph->nodes, worldX, worldY, SLOT_RADIUS / camera->scale);
+        }
+        if (i != -1) {
+            editor->connectingNode = i;
+            editor->connectStartX = graph->nodes[i].outputX;
+            editor->connectStartY = graph->nodes[i].outputY;
+            editor_log(editor, "Starting connection from %s\n", graph->nodes[i].name);
+        }
+
+        if (editor->connectingNode == -1) {
+            i = hit_test_header(&editor->hitTest, graph->nodes, worldX, worldY);
+            if (i != -1) {
+                undo_begin(&editor->undo);
+                editor->dragRecording = true;
+                editor->draggedNode = i;
+                editor->dragOffsetX = worldX - graph->nodes[i].x;
+                editor->dragOffsetY = worldY - graph->nodes[i].y;
+                editor_log(editor, "Dragging %s at (%.0f, %.0f)\n", graph->nodes[i].name, graph->nodes[i].x, graph->nodes[i].y);
+            }
+        }
+    }
+    else if (button->button == SDL_BUTTON_RIGHT) {
+        char name[32];
+        snprintf(name, sizeof(name), "%s %d", node_type_name(editor->addType), graph->nodeCount);
+        undo_begin(&editor->undo);
+        int i = editor_add_node(editor, editor->addType, snap(editor, worldX), snap(editor, worldY), name);
+        undo_end(&editor->undo);
+        if (i != -1) {
+            editor_log(editor, "Added %s at (%.0f, %.0f)\n", graph->nodes[i].name, graph->nodes[i].x, graph->nodes[i].y);
+        }
+    }
+    else if (button->button == SDL_BUTTON_MIDDLE) {
+        editor->panning = true;
+        editor->panStartX = button->x;
+        editor->panStartY = button->y;
+    }
+}
+
+static void handle_button_up(Editor* editor, const SDL_MouseButtonEvent* button) {
+    Graph* graph = &editor->graph;
+    const Camera* camera = &editor->camera;
+    float worldX = (button->x + camera->x) / camera->scale;
+    float worldY = (button->y + camera->y) / camera->scale;
+
+    if (button->button == SDL_BUTTON_LEFT) {
+        if (editor->connectingNode != -1) {
+            int slot;
+            int i = hit_test_input_slot(&editor->hitTest, graph->nodes, worldX, worldY, SLOT_RADIUS / camera->scale,
+                                        editor->connectingNode, &slot);
+            if (i != -1) {
+                undo_begin(&editor->undo);
+                int c = editor_connect(editor, editor->connectingNode, i, slot);
+                undo_end(&editor->undo);
+                if (c != -1) {
+                    editor_log(editor, "Connected %s to input %d of %s\n", graph->nodes[editor->connectingNode].name,
+                               slot + 1, graph->nodes[i].name);
+                } else {
+                    editor_log(editor, "Input %d of %s is taken or of another type\n", slot + 1, graph->nodes[i].name);
+                }
+            }
+            editor->connectingNode = -1;
+        }
+        if (editor->draggedNode != -1) {
+            const Node2D* node = &graph->nodes[editor->draggedNode];
+            editor_log(editor, "Dropped %s at (%.0f, %.0f)\n", node->name, node->x, node->y);
+            editor->draggedNode = -1;
+        }
+        if (editor->dragRecording) {
+            undo_end(&editor->undo);
+            editor->dragRecording = false;
+        }
+    }
+    else if (button->button == SDL_BUTTON_MIDDLE && editor->panning) {
+        // A middle click that did not move is a disconnect. Clustered wires are drawn as chords,
+        // or not at all, so picking the curves there would miss what is on screen.
+        if (fabsf(button->x - editor->panStartX) < 2 && fabsf(button->y - editor->panStartY) < 2 &&
+            lod_level(camera->scale) != LOD_CLUSTERS) {
+            int i;
+            undo_begin(&editor->undo);
+            while ((i = hit_test_wire(&editor->hitTest, graph->nodes, graph->connections, worldX, worldY,
+                                      DISCONNECT_DISTANCE / camera->scale)) != -1) {
+                editor_log(editor, "Disconnected %s from %s\n", graph->nodes[graph->connections[i].fromNode].name,
+                           graph->nodes[graph->connections[i].toNode].name);
+                editor_remove_connection(editor, i);
+            }
+            undo_end(&editor->undo);
+        }
+        editor->panning = false;
+        editor_log(editor, "Panned to (%.2f, %.2f)\n", camera->x, camera->y);
+        editor->dirty = true;
+    }
+}
+
+static void handle_motion(Editor* editor, const SDL_MouseMotionEvent* motion) {
+    Camera* camera = &editor->camera;
+    if (editor->draggedNode != -1) {
+        float worldX = (motion->x + camera->x) / camera->scale;
+        float worldY = (motion->y + camera->y) / camera->scale;
+        Node2D* node = &editor->graph.nodes[editor->draggedNode];
+        float x = snap(editor, worldX - editor->dragOffsetX);
+        float y = snap(editor, worldY - editor->dragOffsetY);
+        // With snapping most motion stays inside one grid cell; nothing to update then.
+        if (x != node->x || y != node->y) {
+            UndoItem move = {.op = UNDO_MOVE, .node = editor->draggedNode, .toNode = -1,
+                             .x = node->x, .y = node->y, .toX = x, .toY = y};
+            undo_record(&editor->undo, &move);
+            node->x = x;
+            node->y = y;
+            sync_node(editor, editor->draggedNode);
+            editor->dirty = true;
+        }
+    }
+    else if (editor->panning) {
+        camera->x -= motion->x - editor->panStartX;
+        camera->y -= motion->y - editor->panStartY;
+        editor->panStartX = motion->x;
+        editor->panStartY = motion->y;
+        editor->dirty = true;
+    }
+    else if (editor->connectingNode != -1) {
+        editor->dirty = true; // the preview wire follows the pointer
+    }
+}
+
+// Steps the constant of the Variable under the pointer, or flips the Toggle under it.
+static void adjust_value(Editor* editor, float step) {
+    const Camera* camera = &editor->camera;
+    float worldX = (editor->mouseX + camera->x) / camera->scale;
+    float worldY = (editor->mouseY + camera->y) / camera->scale;
+    int i = hit_test_node(&editor->hitTest, editor->graph.nodes, worldX, worldY);
+    if (i == -1) return;
+    const Node2D* node = &editor->graph.nodes[i];
+    float value;
+    if (node->type == NODE_VARIABLE) value = node->value + step;
+    else if (node->type == NODE_TOGGLE) value = node->value != 0.0f ? 0.0f : 1.0f;
+    else return;
+    undo_begin(&editor->undo);
+    editor_set_value(editor, i, value);
+    undo_end(&editor->undo);
+    editor_log(editor, "Set %s to %g\n", node->name, node->value);
+}
+
+static bool is_json_path(const char* path) {
+    size_t length = strlen(path);
+    return length >= 5 && strcmp(path + length - 5, ".json") == 0;
+}
+
+bool editor_save(Editor* editor, const char* path) {
+    bool ok = is_json_path(path) ? graph_json_save(&editor->graph, path) : graph_file_save(&editor->graph, path);
+    if (!ok) return false;
+    editor_log(editor, "Saved %d nodes and %d connections to %s\n",
+               editor->graph.liveNodeCount, editor->graph.connectionCount, path);
+    return true;
+}
+
+bool editor_load(Editor* editor, const char* path) {
+    // Load into fresh storage so a bad file leaves the current graph untouched.
+    Graph loaded;
+    HitTest hitTest;
+    if (!graph_init(&loaded)) {
+        printf("Failed to allocate graph storage\n");
+        return false;
+    }
+    bool ok = is_json_path(path) ? graph_json_load(&loaded, path) : graph_file_load(&loaded, path);
+    if (!ok) {
+        graph_destroy(&loaded);
+        return false;
+    }
+    if (!hit_test_init(&hitTest)) {
+        printf("Failed to create spatial index\n");
+        graph_destroy(&loaded);
+        return false;
+    }
+    graph_destroy(&editor->graph);
+    hit_test_destroy(&editor->hitTest);
+    editor->graph = loaded;
+    editor->hitTest = hitTest;
+    editor->draggedNode = -1;
+    editor->connectingNode = -1;
+    editor->panning = false;
+    if (editor->dragRecording) {
+        undo_end(&editor->undo);
+        editor->dragRecording = false;
+    }
+    undo_clear(&editor->undo);
+    eval_mark_all(&editor->eval);
+
+    Graph* graph = &editor->graph;
+    for (int i = 0; i < graph->nodeCount; i++) hit_test_update_node(&editor->hitTest, graph->nodes, i);
+    wire_batch_truncate(&editor->wires, 0);
+    for (int c = 0; c < graph->connectionCount; c++) sync_connection(editor, c);
+    autosave_mark_all(&editor->autosave, graph);
+    editor->dirty = true;
+    editor_log(editor, "Loaded %d nodes and %d connections from %s\n", graph->liveNodeCount, graph->connectionCount, path);
+    return true;
+}
+
+void editor_handle_event(Editor* editor, const SDL_Event* event) {
+    switch (event->type) {
+    case SDL_EVENT_KEY_DOWN:
+        editor->dirty = true;
+        if (event->key.key == SDLK_DELETE) {
+            if (editor->draggedNode != -1) {
+                editor_log(editor, "Deleted %s\n", editor->graph.nodes[editor->draggedNode].name);
+                int node = editor->draggedNode;
+                undo_begin(&editor->undo);
+                editor_delete_nodes(editor, &node, 1);
+                undo_end(&editor->undo);
+            }
+        }
+        else if (event->key.key == SDLK_PLUS || event->key.key == SDLK_EQUALS) {
+            zoom_at_pointer(editor, ZOOM_STEP);
+        }
+        else if (event->key.key == SDLK_MINUS) {
+            zoom_at_pointer(editor, -ZOOM_STEP);
+        }
+        else if (event->key.key == SDLK_Z && (event->key.mod & SDL_KMOD_CTRL)) {
+            if (event->key.mod & SDL_KMOD_SHIFT) editor_redo(editor);
+            else editor_undo(editor);
+        }
+        else if (event->key.key == SDLK_Y && (event->key.mod & SDL_KMOD_CTRL)) {
+            editor_redo(editor);
+        }
+        else if (event->key.key == SDLK_S && (event->key.mod & SDL_KMOD_CTRL)) {
+            editor_save(editor, GRAPH_FILE_PATH);
+        }
+        else if (event->key.key == SDLK_O && (event->key.mod & SDL_KMOD_CTRL)) {
+            editor_load(editor, GRAPH_FILE_PATH);
+        }
+        else if (event->key.key == SDLK_E && (event->key.mod & SDL_KMOD_CTRL)) {
+            editor_save(editor, GRAPH_JSON_PATH);
+        }
+        else if (event->key.key == SDLK_I && (event->key.mod & SDL_KMOD_CTRL)) {
+            editor_load(editor, GRAPH_JSON_PATH);
+        }
+        else if (event->key.key == SDLK_TAB) {
+            editor->addType = (NodeType)((editor->addType + 1) % NODE_TYPE_COUNT);
+            editor_log(editor, "Right click adds %s nodes\n", node_type_name(editor->addType));
+        }
+        else if (event->key.key == SDLK_UP || event->key.key == SDLK_DOWN) {
+            adjust_value(editor, event->key.key == SDLK_UP ? 1.0f : -1.0f);
+        }
+        else if (event->key.key == SDLK_G) {
+            editor->gridSnapping = !editor->gridSnapping;
+            editor_log(editor, "Grid snapping %s\n", editor->gridSnapping ? "enabled" : "disabled");
+            editor->dirty = true;
+        }
+        break;
+    case SDL_EVENT_MOUSE_WHEEL:
+        editor->dirty = true;
+        if (event->wheel.y > 0) zoom_at_pointer(editor, ZOOM_STEP);
+        else if (event->wheel.y < 0) zoom_at_pointer(editor, -ZOOM_STEP);
+        break;
+    case SDL_EVENT_MOUSE_BUTTON_DOWN:
+        editor->mouseX = event->button.x;
+        editor->mouseY = event->button.y;
+        editor->dirty = true; // selection and connection outlines change on press and release
+        handle_button_down(editor, &event->button);
+        break;
+    case SDL_EVENT_MOUSE_BUTTON_UP:
+        editor->mouseX = event->button.x;
+        editor->mouseY = event->button.y;
+        editor->dirty = true;
+        handle_button_up(editor, &event->button);
+        break;
+    case SDL_EVENT_MOUSE_MOTION:
+        editor->mouseX = event->motion.x;
+        editor->mouseY = event->motion.y;
+        handle_motion(editor, &event->motion);
+        break;
+    default:
+        if (event->type >= SDL_EVENT_WINDOW_FIRST && event->type <= SDL_EVENT_WINDOW_LAST) {
+            editor->dirty = true; // exposed, resized, restored: the old frame may be gone
+        }
+        break;
+    }
+}
+
+void editor_render(Editor* editor) {
+    const Graph* graph = &editor->graph;
+    const Camera* camera = &editor->camera;
+
+    Uint64 evalStart = SDL_GetPerformanceCounter();
+    int evaluated = eval_update(&editor->eval, graph);
+    float evalMs = (float)((double)(SDL_GetPerformanceCounter() - evalStart) * 1000.0 / (double)SDL_GetPerformanceFrequency());
+
+    int hoveredInput = -1, hoveredSlot = 0;
+    if (editor->connectingNode != -1) {
+        float worldX = (editor->mouseX + camera->x) / camera->scale;
+        float worldY = (editor->mouseY + camera->y) / camera->scale;
+        hoveredInput = hit_test_input_slot(&editor->hitTest, graph->nodes, worldX, worldY, SLOT_RADIUS / camera->scale,
+                                           editor->connectingNode, &hoveredSlot);
+        wire_batch_set_preview(&editor->wires, true, editor->connectStartX, editor->connectStartY, worldX, worldY);
+    } else {
+        wire_batch_set_preview(&editor->wires, false, 0.0f, 0.0f, 0.0f, 0.0f);
+    }
+    wire_batch_upload(&editor->wires);
+    wire_batch_draw(&editor->wires, &editor->stream, camera, editor->viewWidth, editor->viewHeight);
+
+    LodLevel lod = lod_level(camera->scale);
+    NodeBatch* nodeBatch = &editor->nodeBatch;
+    node_batch_begin(nodeBatch);
+    // The query result is only valid until the next grid query, so pick before culling.
+    const int* visible = NULL;
+    int visibleCount = 0;
+    if (lod == LOD_CLUSTERS) {
+        node_batch_push_clusters(nodeBatch, &editor->hitTest.nodeGrid, camera, editor->viewWidth, editor->viewHeight,
+                                 &editor->frame);
+        if (editor->draggedNode != -1) {
+            node_batch_push_node(nodeBatch, &graph->nodes[editor->draggedNode], true, lod);
+        }
+    } else {
+        visibleCount = spatial_grid_query(&editor->hitTest.nodeGrid,
+                                          camera->x / camera->scale - LABEL_OVERHANG,
+                                          camera->y / camera->scale,
+                                          (camera->x + editor->viewWidth) / camera->scale,
+                                          (camera->y + editor->viewHeight) / camera->scale,
+                                          &visible);
+        for (int v = 0; v < visibleCount; v++) {
+            int i = visible[v];
+            node_batch_push_node(nodeBatch, &graph->nodes[i], i == editor->draggedNode, lod);
+        }
+    }
+    if (editor->connectingNode != -1) {
+        node_batch_push(nodeBatch, NODE_LAYER_OVERLAY, editor->connectStartX - OUTLINE_RADIUS, editor->connectStartY - OUTLINE_RADIUS,
+                        OUTLINE_RADIUS * 2, OUTLINE_RADIUS * 2, 1.0f, 1.0f, 1.0f, NODE_SHAPE_CIRCLE);
+    }
+    if (hoveredInput != -1) {
+        const Node2D* node = &graph->nodes[hoveredInput];
+        node_batch_push(nodeBatch, NODE_LAYER_OVERLAY, node->inputX - OUTLINE_RADIUS, node->inputY[hoveredSlot] - OUTLINE_RADIUS,
+                        OUTLINE_RADIUS * 2, OUTLINE_RADIUS * 2, 1.0f, 1.0f, 1.0f, NODE_SHAPE_CIRCLE);
+    }
+    node_batch_upload(nodeBatch, &editor->stream, camera, editor->viewWidth, editor->viewHeight);
+    node_batch_draw(nodeBatch, NODE_LAYER_BODY, NODE_LAYER_SLOT);
+
+    text_batch_begin(&editor->labels);
+    if (lod == LOD_FULL) {
+        for (int v = 0; v < visibleCount; v++) {
+            const Node2D* node = &graph->nodes[visible[v]];
+            text_batch_add(&editor->labels, &editor->atlas, node->name, node->x + 5, node->y - 2, 1.0f);
+            char value[32];
+            eval_format_value(&editor->eval, graph, visible[v], value, sizeof(value));
+            text_batch_add(&editor->labels, &editor->atlas, value, node->x + SLOT_RADIUS + 4, node->y + HEADER_HEIGHT + 2, 1.0f);
+        }
+    }
+    text_batch_draw(&editor->labels, &editor->stream, &editor->atlas, camera, editor->viewWidth, editor->viewHeight, 1.0f, 1.0f, 1.0f);
+
+    node_batch_draw(nodeBatch, NODE_LAYER_OVERLAY, NODE_LAYER_OVERLAY);
+
+    HudStatus status = {camera->x, camera->y, camera->scale, editor->gridSnapping,
+                        graph->liveNodeCount, graph->connectionCount, editor->frameMs,
+                        editor->framesRendered, editor->framesSkipped, 0, 0.0f, 0.0f,
+                        evaluated, evalMs, editor->eval.cyclicCount, node_type_name(editor->addType),
+                        editor->pool.threadCount, editor->frameHeapCalls, editor->frame.peak,
+                        editor->frame.capacity, stream_buffer_mode_name(editor->stream.mode),
+                        editor->stream.peak, editor->stream.regionBytes};
+    autosave_stats(&editor->autosave, &status.autosaves, &status.snapshotMs, &status.writeMs);
+    hud_draw(&editor->hud, &editor->stream, &editor->atlas, &status, editor->viewWidth, editor->viewHeight);
+}
+
+void editor_end_frame(Editor* editor) {
+    arena_reset(&editor->frame);
+    stream_buffer_end_frame(&editor->stream);
+    MemStats stats = mem_stats();
+    editor->frameHeapCalls = (int)(mem_heap_calls(&stats) - editor->heapCalls);
+    editor->heapCalls = mem_heap_calls(&stats);
+}
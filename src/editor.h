@@ -0,0 +1,98 @@
+#ifndef EDITOR_H
+#define EDITOR_H
+
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <stdbool.h>
+#include "node2d.h"
+#include "graph.h"
+#include "hit_test.h"
+#include "node_batch.h"
+#include "wire_batch.h"
+#include "text_atlas.h"
+#include "hud.h"
+#include "autosave.h"
+#include "undo.h"
+#include "eval.h"
+#include "arena.h"
+#include "stream_buffer.h"
+
+// The node editor without its window: graph, picking, renderers and interaction state.
+// main.c feeds it SDL events and asks it to draw; the benchmark drives it the same way
+// with scripted events and an offscreen framebuffer.
+typedef struct {
+    Graph graph;
+    HitTest hitTest;
+    NodeBatch nodeBatch;
+    WireBatch wires;
+    TextAtlas atlas;
+    TextBatch labels;
+    Hud hud;
+    Autosave autosave; // idle until started by the application
+    UndoJournal undo;
+    Evaluator eval; // node values, brought up to date before each frame is drawn
+    TaskPool pool;  // threads for full evaluation passes
+    Arena frame;    // scratch for the frame being drawn, emptied by editor_end_frame
+    StreamBuffer stream; // vertex data of the frame being drawn, fenced by editor_end_frame
+
+    Camera camera;
+    float viewWidth, viewHeight;
+    float mouseX, mouseY; // last pointer position seen in an event, window pixels
+
+    int draggedNode;
+    float dragOffsetX, dragOffsetY;
+    int connectingNode;
+    float connectStartX, connectStartY;
+    bool dragRecording; // the drag is an open undo entry, closed on release
+    bool panning;
+    float panStartX, panStartY;
+    bool gridSnapping;
+    NodeType addType; // type of the nodes added with a right click
+
+    // Set by every change that affects the picture (graph edits, camera, selection, the
+    // connection preview, window exposure). The main loop only draws while it is set and
+    // clears it after presenting a frame.
+    bool dirty;
+    float frameMs;      // last frame time, shown in the HUD; set by the main loop
+    int framesRendered; // main loop iterations that drew, and those that found nothing to draw
+    int framesSkipped;
+    bool verbose;       // print a line per user action
+    long long heapCalls; // mem_heap_calls at the end of the last frame
+    int frameHeapCalls;  // during the last frame, on any thread; 0 once buffers have grown
+} Editor;
+
+// Needs a current GL 3.3 context. The font is only used to bake the glyph atlas.
+bool editor_init(Editor* editor, TTF_Font* font, float viewWidth, float viewHeight);
+void editor_destroy(Editor* editor);
+
+// Graph edits that keep the picker and wire renderer in sync. Used by the event handlers
+// and by code that builds graphs directly. They are recorded for undo only inside
+// undo_begin/undo_end on editor->undo, as the event handlers do, so one call or a whole batch
+// becomes a single undo step.
+int editor_add_node(Editor* editor, NodeType type, float x, float y, const char* name);
+// Refuses an input that is already connected or of a different value type.
+int editor_connect(Editor* editor, int fromNode, int toNode, int toSlot);
+void editor_remove_connection(Editor* editor, int index);
+// Removes the nodes and every connection touching them, O(degree) per node.
+void editor_delete_nodes(Editor* editor, const int* indices, int count);
+// Sets the constant of a Variable or Toggle node.
+void editor_set_value(Editor* editor, int node, float value);
+
+// Writes the graph to a file, or replaces it with one: JSON for paths ending in .json, the
+// binary graph file otherwise. A failed load keeps the current graph.
+bool editor_save(Editor* editor, const char* path);
+bool editor_load(Editor* editor, const char* path);
+
+// Reverts the last recorded edit or reapplies the last reverted one. Return false if there is
+// nothing to undo or redo, or while an edit such as a drag is still in progress.
+bool editor_undo(Editor* editor);
+bool editor_redo(Editor* editor);
+
+void editor_handle_event(Editor* editor, const SDL_Event* event);
+// Draws the graph and the HUD into the current framebuffer. Does not clear or swap.
+void editor_render(Editor* editor);
+// Call after presenting a frame: releases the frame's scratch memory, fences its vertex
+// data and counts the heap calls made since the last call.
+void editor_end_frame(Editor* editor);
+
+#endif
@@ -0,0 +1,309 @@
+#include "eval.h"
+#include "mem.h"
+#include <stdio.h>
+#include <string.h>
+
+#define N VALUE_NUMBER
+#define B VALUE_BOOL
+const NodeSignature nodeSignatures[NODE_TYPE_COUNT] = {
+    [NODE_VARIABLE] = {{N}, N},
+    [NODE_TOGGLE] = {{N}, B},
+    [NODE_ADD] = {{N, N}, N},
+    [NODE_SUBTRACT] = {{N, N}, N},
+    [NODE_MULTIPLY] = {{N, N}, N},
+    [NODE_DIVIDE] = {{N, N}, N},
+    [NODE_MIN] = {{N, N}, N},
+    [NODE_MAX] = {{N, N}, N},
+    [NODE_LESS] = {{N, N}, B},
+    [NODE_GREATER] = {{N, N}, B},
+    [NODE_EQUAL] = {{N, N}, B},
+    [NODE_AND] = {{B, B}, B},
+    [NODE_OR] = {{B, B}, B},
+    [NODE_NOT] = {{B}, B},
+    [NODE_SELECT] = {{B, N, N}, N},
+};
+#undef N
+#undef B
+
+bool eval_init(Evaluator* eval) {
+    memset(eval, 0, sizeof(*eval));
+    eval->planDirty = true;
+    eval->markAll = true;
+    return true;
+}
+
+void eval_destroy(Evaluator* eval) {
+    mem_free(eval->steps);
+    mem_free(eval->levelStart);
+    mem_free(eval->rank);
+    mem_free(eval->values);
+    mem_free(eval->queued);
+    mem_free(eval->indegree);
+    mem_free(eval->heap);
+    mem_free(eval->marked);
+    memset(eval, 0, sizeof(*eval));
+}
+
+// Grows the per-node arrays to cover every slot of the graph; new slots are not in the plan.
+static bool reserve_nodes(Evaluator* eval, int needed) {
+    if (needed <= eval->nodeCapacity) return true;
+    int capacity = eval->nodeCapacity ? eval->nodeCapacity : 64;
+    while (capacity < needed) capacity *= 2;
+    EvalStep* steps = mem_realloc(eval->steps, (size_t)capacity * sizeof(EvalStep));
+    if (steps) eval->steps = steps;
+    int* rank = mem_realloc(eval->rank, (size_t)capacity * sizeof(int));
+    if (rank) eval->rank = rank;
+    float* values = mem_realloc(eval->values, (size_t)capacity * sizeof(float));
+    if (values) eval->values = values;
+    unsigned char* queued = mem_realloc(eval->queued, (size_t)capacity);
+    if (queued) eval->queued = queued;
+    int* indegree = mem_realloc(eval->indegree, (size_t)capacity * sizeof(int));
+    if (indegree) eval->indegree = indegree;
+    int* heap = mem_realloc(eval->heap, (size_t)capacity * sizeof(int));
+    if (heap) eval->heap = heap;
+    int* levelStart = mem_realloc(eval->levelStart, ((size_t)capacity + 1) * sizeof(int));
+    if (levelStart) eval->levelStart = levelStart;
+    if (!steps || !rank || !values || !queued || !indegree || !heap || !levelStart) {
+        printf("Cannot evaluate graph: out of memory at %d nodes\n", needed);
+        return false;
+    }
+    for (int i = eval->nodeCapacity; i < capacity; i++) {
+        rank[i] = -1;
+        values[i] = 0.0f;
+        queued[i] = 0;
+    }
+    eval->nodeCapacity = capacity;
+    return true;
+}
+
+static bool valid_input(const Graph* graph, int connection) {
+    const Connection* c = &graph->connections[connection];
+    return eval_types_match(&graph->nodes[c->fromNode], &graph->nodes[c->toNode], c->toSlot);
+}
+
+void eval_mark_node(Evaluator* eval, int node) {
+    if (eval->markAll) return;
+    if (eval->markedCount == eval->markedCapacity) {
+        int capacity = eval->markedCapacity ? eval->markedCapacity * 2 : 64;
+        int* marked = mem_realloc(eval->marked, (size_t)capacity * sizeof(int));
+        if (!marked) {
+            eval->markAll = true; // recompute everything rather than lose the mark
+            return;
+        }
+        eval->marked = marked;
+        eval->markedCapacity = capacity;
+    }
+    eval->marked[eval->markedCount++] = node;
+}
+
+void eval_mark_all(Evaluator* eval) {
+    eval->planDirty = true;
+    eval->markAll = true;
+    eval->markedCount = 0;
+}
+
+// Kahn's algorithm over the valid connections. The steps array doubles as the queue: nodes
+// are appended once all their inputs are scheduled and taken from the front in order. Taken
+// first in first out, the queue comes out sorted by level: the nodes appended while level l
+// is taken are exactly those whose last scheduled input is on level l, so they form level
+// l + 1, and the level boundaries fall out of the walk.
+static bool compile(Evaluator* eval, const Graph* graph) {
+    if (!reserve_nodes(eval, graph->nodeCount)) return false;
+    int* indegree = eval->indegree;
+    EvalStep* steps = eval->steps;
+    int tail = 0;
+    eval->mistypedCount = 0;
+    for (int i = 0; i < graph->nodeCount; i++) {
+        indegree[i] = 0;
+        if (!graph_node_alive(graph, i)) continue;
+        for (int c = graph_first_in(graph, i); c != -1; c = graph_next_in(graph, c)) {
+            if (valid_input(graph, c)) indegree[i]++;
+            else eval->mistypedCount++;
+        }
+        if (indegree[i] == 0) steps[tail++].node = i;
+    }
+    int* levelStart = eval->levelStart;
+    int levelCount = 0;
+    int levelEnd = tail; // end of the level being taken
+    levelStart[0] = 0;
+    for (int head = 0; head < tail; head++) {
+        if (head == levelEnd) {
+            levelStart[++levelCount] = head;
+            levelEnd = tail;
+        }
+        int node = steps[head].node;
+        for (int c = graph_first_out(graph, node); c != -1; c = graph_next_out(graph, c)) {
+            int to = graph->connections[c].toNode;
+            if (valid_input(graph, c) && --indegree[to] == 0) steps[tail++].node = to;
+        }
+    }
+    if (tail > 0) levelCount++;
+    levelStart[levelCount] = tail;
+    eval->levelCount = levelCount;
+    eval->stepCount = tail;
+    eval->cyclicCount = graph->liveNodeCount - tail;
+
+    // Nodes that just joined the plan, e.g. because a cycle was broken, have no value yet.
+    for (int k = 0; k < tail; k++) {
+        if (eval->rank[steps[k].node] == -1) eval_mark_node(eval, steps[k].node);
+    }
+    for (int i = 0; i < graph->nodeCount; i++) eval->rank[i] = -1;
+    for (int k = 0; k < tail; k++) {
+        EvalStep* step = &steps[k];
+        eval->rank[step->node] = k;
+        step->type = graph->nodes[step->node].type;
+        for (int s = 0; s < NODE_MAX_INPUTS; s++) step->inputs[s] = -1;
+        for (int c = graph_first_in(graph, step->node); c != -1; c = graph_next_in(graph, c)) {
+            if (valid_input(graph, c)) step->inputs[graph->connections[c].toSlot] = graph->connections[c].fromNode;
+        }
+    }
+    eval->planDirty = false;
+    return true;
+}
+
+bool eval_compile(Evaluator* eval, const Graph* graph) {
+    return compile(eval, graph);
+}
+
+float eval_step(const EvalStep* step, const float* values, const Node2D* nodes) {
+    float a = step->inputs[0] != -1 ? values[step->inputs[0]] : 0.0f;
+    float b = step->inputs[1] != -1 ? values[step->inputs[1]] : 0.0f;
+    switch (step->type) {
+    case NODE_VARIABLE: return step->inputs[0] != -1 ? a : nodes[step->node].value;
+    case NODE_TOGGLE: return nodes[step->node].value != 0.0f;
+    case NODE_ADD: return a + b;
+    case NODE_SUBTRACT: return a - b;
+    case NODE_MULTIPLY: return a * b;
+    case NODE_DIVIDE: return a / b;
+    case NODE_MIN: return eval_min(a, b);
+    case NODE_MAX: return eval_max(a, b);
+    case NODE_LESS: return a < b;
+    case NODE_GREATER: return a > b;
+    case NODE_EQUAL: return a == b;
+    case NODE_AND: return a != 0.0f && b != 0.0f;
+    case NODE_OR: return a != 0.0f || b != 0.0f;
+    case NODE_NOT: return a == 0.0f;
+    case NODE_SELECT: {
+        float c = step->inputs[2] != -1 ? values[step->inputs[2]] : 0.0f;
+        return a != 0.0f ? b : c;
+    }
+    default: return 0.0f;
+    }
+}
+
+static void run_steps(Evaluator* eval, const Graph* graph, int first, int last) {
+    for (int k = first; k < last; k++) {
+        const EvalStep* step = &eval->steps[k];
+        eval->values[step->node] = eval_step(step, eval->values, graph->nodes);
+    }
+}
+
+typedef struct {
+    Evaluator* eval;
+    const Graph* graph;
+    int first, last; // the level's steps
+} LevelRun;
+
+// Steps of one level write disjoint nodes and only read values of earlier levels, so the
+// chunks need no synchronization beyond the join after the level.
+static void run_chunk(void* data, int task, int worker) {
+    (void)worker;
+    LevelRun* run = data;
+    int first = run->first + task * EVAL_PARALLEL_CHUNK;
+    int last = first + EVAL_PARALLEL_CHUNK < run->last ? first + EVAL_PARALLEL_CHUNK : run->last;
+    run_steps(run->eval, run->graph, first, last);
+}
+
+void eval_run(Evaluator* eval, const Graph* graph) {
+    if (!eval->pool || eval->pool->threadCount == 1) {
+        run_steps(eval, graph, 0, eval->stepCount);
+    } else {
+        for (int l = 0; l < eval->levelCount; l++) {
+            LevelRun run = {eval, graph, eval->levelStart[l], eval->levelStart[l + 1]};
+            int width = run.last - run.first;
+            if (width < EVAL_PARALLEL_MIN_STEPS) {
+                run_steps(eval, graph, run.first, run.last);
+                continue;
+            }
+            task_pool_run(eval->pool, (width + EVAL_PARALLEL_CHUNK - 1) / EVAL_PARALLEL_CHUNK, run_chunk, &run);
+        }
+    }
+    eval->lastEvaluations = eval->stepCount;
+    eval->evaluations += eval->stepCount;
+}
+
+static void heap_push(Evaluator* eval, int node) {
+    int* heap = eval->heap;
+    int i = eval->heapCount++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (eval->rank[heap[parent]] <= eval->rank[node]) break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = node;
+    eval->queued[node] = 1;
+}
+
+static int heap_pop(Evaluator* eval) {
+    int* heap = eval->heap;
+    int top = heap[0];
+    int last = heap[--eval->heapCount];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= eval->heapCount) break;
+        if (child + 1 < eval->heapCount && eval->rank[heap[child + 1]] < eval->rank[heap[child]]) child++;
+        if (eval->rank[heap[child]] >= eval->rank[last]) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    if (eval->heapCount > 0) heap[i] = last;
+    eval->queued[top] = 0;
+    return top;
+}
+
+int eval_update(Evaluator* eval, const Graph* graph) {
+    if (eval->planDirty && !compile(eval, graph)) return -1;
+    if (eval->markAll) {
+        eval->markAll = false;
+        eval->markedCount = 0;
+        eval_run(eval, graph);
+        return eval->lastEvaluations;
+    }
+
+    for (int m = 0; m < eval->markedCount; m++) {
+        int node = eval->marked[m];
+        if (eval_has_value(eval, node) && !eval->queued[node]) heap_push(eval, node);
+    }
+    eval->markedCount = 0;
+
+    // Popping in rank order computes every node after all of its queued inputs, so each
+    // affected node is evaluated once however many of its inputs changed.
+    int evaluated = 0;
+    while (eval->heapCount > 0) {
+        int node = heap_pop(eval);
+        float value = eval_step(&eval->steps[eval->rank[node]], eval->values, graph->nodes);
+        evaluated++;
+        // Bitwise, so a sign flip of zero still reaches a divide downstream.
+        if (memcmp(&value, &eval->values[node], sizeof(value)) == 0) continue; // nothing downstream changes
+        eval->values[node] = value;
+        for (int c = graph_first_out(graph, node); c != -1; c = graph_next_out(graph, c)) {
+            int to = graph->connections[c].toNode;
+            if (eval->rank[to] != -1 && !eval->queued[to]) heap_push(eval, to);
+        }
+    }
+    eval->lastEvaluations = evaluated;
+    eval->evaluations += evaluated;
+    return evaluated;
+}
+
+void eval_format_value(const Evaluator* eval, const Graph* graph, int node, char* text, int size) {
+    if (!eval_has_value(eval, node)) {
+        snprintf(text, size, "cycle");
+    } else if (nodeSignatures[graph->nodes[node].type].output == VALUE_BOOL) {
+        snprintf(text, size, "%s", eval->values[node] != 0.0f ? "true" : "false");
+    } else {
+        snprintf(text, size, "%g", eval->values[node]);
+    }
+}
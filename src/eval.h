@@ -0,0 +1,110 @@
+#ifndef EVAL_H
+#define EVAL_H
+
+#include <stdbool.h>
+#include "graph.h"
+#include "task_pool.h"
+
+// Levels narrower than this are evaluated on the calling thread: waking the pool costs
+// about as much as evaluating a few thousand nodes.
+#define EVAL_PARALLEL_MIN_STEPS 4096
+#define EVAL_PARALLEL_CHUNK 1024 // steps per task
+
+typedef enum {
+    VALUE_NUMBER,
+    VALUE_BOOL // stored as 0 or 1
+} ValueType;
+
+// Types of each node type's inputs and output. A connection is only valid between an output
+// and an input of the same type.
+typedef struct {
+    ValueType inputs[NODE_MAX_INPUTS];
+    ValueType output;
+} NodeSignature;
+
+extern const NodeSignature nodeSignatures[NODE_TYPE_COUNT];
+
+static inline bool eval_types_match(const Node2D* from, const Node2D* to, int toSlot) {
+    return toSlot >= 0 && toSlot < node_input_count(to->type) &&
+           nodeSignatures[from->type].output == nodeSignatures[to->type].inputs[toSlot];
+}
+
+// One node of the execution plan with the node each of its inputs reads, -1 for an open
+// input, which reads 0 or false.
+typedef struct {
+    int node;
+    NodeType type;
+    int inputs[NODE_MAX_INPUTS];
+} EvalStep;
+
+// Evaluates the graph as a dataflow program. The connections are compiled into a plan whose
+// steps are in topological order, so one pass computes every node after its inputs. Nodes
+// on a cycle, and everything downstream of one, are left out of the plan and have no value.
+// The steps are grouped into levels by their longest path from a node without inputs. No
+// step reads another of its own level, so with a task pool each wide level of a full pass
+// is split over the threads, which only synchronize between levels.
+//
+// Evaluation is incremental: edits mark the nodes whose value or inputs changed, and an
+// update recomputes only those and, in plan order, the nodes downstream of them whose
+// inputs actually changed value. Adding or removing nodes and connections recompiles the
+// plan, which is linear in the graph size; the values survive the recompile.
+typedef struct {
+    EvalStep* steps;
+    int stepCount;
+    int* levelStart;       // steps of level l are [levelStart[l], levelStart[l + 1])
+    int levelCount;
+    int* rank;             // per node slot: index of its step, -1 if not in the plan
+    float* values;         // per node slot, valid where rank is not -1
+    unsigned char* queued; // per node slot: waiting in the heap
+    int* indegree;         // per node slot, scratch for compiling
+    int nodeCapacity;
+    int cyclicCount;       // live nodes left out of the plan because of a cycle
+    int mistypedCount;     // connections ignored because their types differ
+    bool planDirty;
+    bool markAll;
+
+    int* marked; // nodes to recompute at the next update
+    int markedCount, markedCapacity;
+    int* heap;   // pending nodes ordered by rank
+    int heapCount;
+
+    long long evaluations; // node evaluations so far, for benchmarks
+    int lastEvaluations;   // in the last update
+    TaskPool* pool;        // set by the owner to evaluate full passes in parallel; may be NULL
+} Evaluator;
+
+bool eval_init(Evaluator* eval);
+void eval_destroy(Evaluator* eval);
+
+// Nodes or connections were added or removed.
+static inline void eval_mark_structure(Evaluator* eval) { eval->planDirty = true; }
+// The node's value, type or inputs changed.
+void eval_mark_node(Evaluator* eval, int node);
+// Everything changed, e.g. a new graph was loaded.
+void eval_mark_all(Evaluator* eval);
+
+// Recompiles the plan if the structure changed, then recomputes the marked nodes and what
+// depends on them. Returns the number of nodes evaluated, or -1 if memory ran out.
+int eval_update(Evaluator* eval, const Graph* graph);
+// The non-incremental path, for benchmarks: compile the plan, then evaluate every step, on
+// the pool's threads if there is one.
+bool eval_compile(Evaluator* eval, const Graph* graph);
+void eval_run(Evaluator* eval, const Graph* graph);
+
+// Computes one step from the values of the nodes it reads, indexed by node slot.
+float eval_step(const EvalStep* step, const float* values, const Node2D* nodes);
+
+// Min and Max as fminf and fmaxf, a NaN loses to a number, but with the sign of a zero result
+// pinned down: the C library may return either of 0 and -0, and inlined or not it does not
+// always pick the same, which every evaluator has to agree on to the bit.
+static inline float eval_min(float a, float b) { return a < b || b != b ? a : b; }
+static inline float eval_max(float a, float b) { return a > b || b != b ? a : b; }
+
+static inline bool eval_has_value(const Evaluator* eval, int node) {
+    return node < eval->nodeCapacity && eval->rank[node] != -1;
+}
+static inline float eval_value(const Evaluator* eval, int node) { return eval->values[node]; }
+// Writes the node's value as text: a number, true/false, or "cycle" if it has none.
+void eval_format_value(const Evaluator* eval, const Graph* graph, int node, char* text, int size);
+
+#endif
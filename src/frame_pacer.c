@@ -0,0 +1,21 @@
+#include "frame_pacer.h"
+#include <stdio.h>
+
+void frame_pacer_init(FramePacer* pacer, int maxFps) {
+    pacer->vsync = SDL_GL_SetSwapInterval(-1) || SDL_GL_SetSwapInterval(1);
+    pacer->frameNs = maxFps > 0 ? SDL_NS_PER_SECOND / (Uint64)maxFps : 0;
+    pacer->nextFrameNs = SDL_GetTicksNS();
+    printf("Frame pacing: %s\n", pacer->vsync ? "vsync" : "capped");
+}
+
+void frame_pacer_wait(FramePacer* pacer) {
+    if (pacer->vsync || pacer->frameNs == 0) return;
+    Uint64 now = SDL_GetTicksNS();
+    if (now < pacer->nextFrameNs) {
+        SDL_DelayPrecise(pacer->nextFrameNs - now);
+        pacer->nextFrameNs += pacer->frameNs;
+    } else {
+        // Running late: start counting from now rather than trying to catch up.
+        pacer->nextFrameNs = now + pacer->frameNs;
+    }
+}
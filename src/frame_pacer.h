@@ -0,0 +1,22 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+// Decides when the next frame starts. With vsync the swap itself blocks, so the pacer only
+// keeps time. Without it, frames are capped at maxFps by sleeping before input is polled:
+// the wait happens first and the frame is built from the freshest input right after it,
+// which keeps input-to-photon latency at one frame instead of one frame plus the sleep.
+typedef struct {
+    bool vsync;
+    Uint64 frameNs;    // target frame length when capping, 0 for no cap
+    Uint64 nextFrameNs; // when the next capped frame may start
+} FramePacer;
+
+// Needs a current GL context. Prefers adaptive vsync, then vsync, then the cap.
+void frame_pacer_init(FramePacer* pacer, int maxFps);
+// Blocks until the next frame should be built. Call at the top of the main loop.
+void frame_pacer_wait(FramePacer* pacer);
+
+#endif
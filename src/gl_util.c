@@ -0,0 +1,53 @@
+#include "gl_util.h"
+#include <stdio.h>
+#include <string.h>
+
+RenderStats renderStats;
+
+void gl_stats_reset(void) {
+    memset(&renderStats, 0, sizeof(renderStats));
+}
+
+static GLuint compile_shader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        printf("%s shader compilation failed: %s\n", type == GL_VERTEX_SHADER ? "Vertex" : "Fragment", infoLog);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+GLuint gl_create_program(const char* vertexSource, const char* fragmentSource) {
+    GLuint vertexShader = compile_shader(GL_VERTEX_SHADER, vertexSource);
+    GLuint fragmentShader = compile_shader(GL_FRAGMENT_SHADER, fragmentSource);
+    if (!vertexShader || !fragmentShader) {
+        if (vertexShader) glDeleteShader(vertexShader);
+        if (fragmentShader) glDeleteShader(fragmentShader);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        printf("Shader program linking failed: %s\n", infoLog);
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
@@ -0,0 +1,22 @@
+#ifndef GL_UTIL_H
+#define GL_UTIL_H
+
+#include <glad/gl.h>
+
+// Counters bumped by the renderers as they issue GL work. Nothing resets them on its own;
+// whoever measures clears them with gl_stats_reset() at the start of a frame.
+typedef struct {
+    int drawCalls;
+    int textureUploads;
+    long long uploadBytes; // buffer and texture data handed to the driver
+    int fenceWaits;        // vertex stream regions the GPU was still reading when reached
+} RenderStats;
+
+extern RenderStats renderStats;
+
+void gl_stats_reset(void);
+
+// Compiles and links a vertex/fragment pair. Prints the info log and returns 0 on failure.
+GLuint gl_create_program(const char* vertexSource, const char* fragmentSource);
+
+#endif
@@ -0,0 +1,171 @@
+#include "graph.h"
+#include "mem.h"
+#include <stdio.h>
+#include <string.h>
+
+#define GRAPH_INITIAL_CAPACITY 64
+
+static bool grow(void** items, int* capacity, int needed, size_t itemSize) {
+    if (needed <= *capacity) return true;
+    int newCapacity = *capacity ? *capacity : GRAPH_INITIAL_CAPACITY;
+    while (newCapacity < needed) newCapacity *= 2;
+    void* grown = mem_realloc(*items, (size_t)newCapacity * itemSize);
+    if (!grown) return false;
+    *items = grown;
+    *capacity = newCapacity;
+    return true;
+}
+
+bool graph_init(Graph* graph) {
+    memset(graph, 0, sizeof(*graph));
+    graph->freeHead = -1;
+    return graph_reserve(graph, GRAPH_INITIAL_CAPACITY, GRAPH_INITIAL_CAPACITY);
+}
+
+void graph_destroy(Graph* graph) {
+    mem_free(graph->nodes);
+    mem_free(graph->slots);
+    mem_free(graph->connections);
+    mem_free(graph->links);
+    memset(graph, 0, sizeof(*graph));
+    graph->freeHead = -1;
+}
+
+static bool reserve_nodes(Graph* graph, int needed) {
+    int slotCapacity = graph->nodeCapacity;
+    return grow((void**)&graph->slots, &slotCapacity, needed, sizeof(NodeSlot)) &&
+           grow((void**)&graph->nodes, &graph->nodeCapacity, needed, sizeof(Node2D));
+}
+
+static bool reserve_connections(Graph* graph, int needed) {
+    int linkCapacity = graph->connectionCapacity;
+    return grow((void**)&graph->links, &linkCapacity, needed, sizeof(ConnectionLinks)) &&
+           grow((void**)&graph->connections, &graph->connectionCapacity, needed, sizeof(Connection));
+}
+
+bool graph_reserve(Graph* graph, int nodeCapacity, int connectionCapacity) {
+    return reserve_nodes(graph, nodeCapacity) && reserve_connections(graph, connectionCapacity);
+}
+
+// Fills a slot that is already off the free list with a default sized node.
+static void occupy_slot(Graph* graph, int index, float x, float y, const char* name) {
+    graph->slots[index].alive = true;
+    graph->slots[index].nextFree = -1;
+    graph->slots[index].firstOut = -1;
+    graph->slots[index].firstIn = -1;
+    graph->liveNodeCount++;
+
+    Node2D* node = &graph->nodes[index];
+    node->x = x;
+    node->y = y;
+    node->width = NODE_WIDTH;
+    node->height = NODE_HEIGHT;
+    node->type = NODE_VARIABLE;
+    node->value = 0.0f;
+    snprintf(node->name, sizeof(node->name), "%s", name);
+    node_update_slots(node);
+}
+
+int graph_add_node(Graph* graph, float x, float y, const char* name) {
+    int index = graph->freeHead;
+    if (index != -1) {
+        graph->freeHead = graph->slots[index].nextFree;
+    } else {
+        if (!reserve_nodes(graph, graph->nodeCount + 1)) {
+            printf("Cannot add node: out of memory at %d nodes\n", graph->liveNodeCount);
+            return -1;
+        }
+        index = graph->nodeCount++;
+        graph->slots[index].generation = 0;
+    }
+    occupy_slot(graph, index, x, y, name);
+    return index;
+}
+
+int graph_restore_node(Graph* graph, int index, float x, float y, const char* name) {
+    if (index < 0 || index >= graph->nodeCount || graph->slots[index].alive) return -1;
+    if (graph->freeHead == index) {
+        graph->freeHead = graph->slots[index].nextFree;
+    } else {
+        int previous = graph->freeHead;
+        while (previous != -1 && graph->slots[previous].nextFree != index) previous = graph->slots[previous].nextFree;
+        if (previous == -1) return -1;
+        graph->slots[previous].nextFree = graph->slots[index].nextFree;
+    }
+    occupy_slot(graph, index, x, y, name);
+    return index;
+}
+
+void graph_remove_node(Graph* graph, int index) {
+    if (!graph_node_alive(graph, index)) return;
+    NodeSlot* slot = &graph->slots[index];
+    slot->alive = false;
+    slot->generation++;
+    slot->nextFree = graph->freeHead;
+    graph->freeHead = index;
+    graph->liveNodeCount--;
+}
+
+NodeHandle graph_node_handle(const Graph* graph, int index) {
+    NodeHandle handle = {index, graph->slots[index].generation};
+    return handle;
+}
+
+int graph_node_resolve(const Graph* graph, NodeHandle handle) {
+    if (!graph_node_alive(graph, handle.index)) return -1;
+    return graph->slots[handle.index].generation == handle.generation ? handle.index : -1;
+}
+
+// Pushes connections[index] onto the front of its endpoints' adjacency lists.
+static void link_connection(Graph* graph, int index) {
+    ConnectionLinks* links = &graph->links[index];
+    NodeSlot* from = &graph->slots[graph->connections[index].fromNode];
+    NodeSlot* to = &graph->slots[graph->connections[index].toNode];
+
+    links->prevOut = -1;
+    links->nextOut = from->firstOut;
+    if (from->firstOut != -1) graph->links[from->firstOut].prevOut = index;
+    from->firstOut = index;
+
+    links->prevIn = -1;
+    links->nextIn = to->firstIn;
+    if (to->firstIn != -1) graph->links[to->firstIn].prevIn = index;
+    to->firstIn = index;
+}
+
+static void unlink_connection(Graph* graph, int index) {
+    const ConnectionLinks* links = &graph->links[index];
+    NodeSlot* from = &graph->slots[graph->connections[index].fromNode];
+    NodeSlot* to = &graph->slots[graph->connections[index].toNode];
+
+    if (links->prevOut != -1) graph->links[links->prevOut].nextOut = links->nextOut;
+    else from->firstOut = links->nextOut;
+    if (links->nextOut != -1) graph->links[links->nextOut].prevOut = links->prevOut;
+
+    if (links->prevIn != -1) graph->links[links->prevIn].nextIn = links->nextIn;
+    else to->firstIn = links->nextIn;
+    if (links->nextIn != -1) graph->links[links->nextIn].prevIn = links->prevIn;
+}
+
+int graph_add_connection(Graph* graph, int fromNode, int toNode, int toSlot) {
+    if (!reserve_connections(graph, graph->connectionCount + 1)) {
+        printf("Cannot add connection: out of memory at %d connections\n", graph->connectionCount);
+        return -1;
+    }
+    int index = graph->connectionCount++;
+    graph->connections[index].fromNode = fromNode;
+    graph->connections[index].toNode = toNode;
+    graph->connections[index].toSlot = toSlot;
+    link_connection(graph, index);
+    return index;
+}
+
+bool graph_remove_connection(Graph* graph, int index) {
+    unlink_connection(graph, index);
+    int last = --graph->connectionCount;
+    if (index == last) return false;
+    unlink_connection(graph, last);
+    graph->connections[index] = graph->connections[last];
+    link_connection(graph, index);
+    return true;
+}
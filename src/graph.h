@@ -0,0 +1,91 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <stdbool.h>
+#include "node2d.h"
+
+// Stable reference to a node. Slot indices never move, but a slot is reused after its node
+// is removed; the generation tells a stale handle apart from the slot's new occupant.
+typedef struct {
+    int index;
+    unsigned generation;
+} NodeHandle;
+
+typedef struct {
+    unsigned generation; // bumped every time the slot is freed
+    int nextFree;        // next slot on the free list, -1 at the end
+    int firstOut;        // head of the node's outgoing connection list, -1 if none
+    int firstIn;         // head of the node's incoming connection list, -1 if none
+    bool alive;
+} NodeSlot;
+
+// Per-connection links of the two doubly linked adjacency lists it belongs to: the
+// outgoing list of its fromNode and the incoming list of its toNode.
+typedef struct {
+    int nextOut, prevOut;
+    int nextIn, prevIn;
+} ConnectionLinks;
+
+// Node and connection storage. Both arrays live on the heap and grow by doubling,
+// so graph size is only bounded by memory. Nodes live in slots that keep their index
+// for the node's whole lifetime; removed slots go on a free list and are reused by
+// later adds. Connections are dense and removed by swapping the last one into the hole.
+typedef struct {
+    Node2D* nodes;    // indexed by slot; only meaningful where slots[i].alive
+    NodeSlot* slots;
+    int nodeCount;    // slots handed out so far, live or free; bound for iteration
+    int liveNodeCount;
+    int nodeCapacity;
+    int freeHead;
+    Connection* connections;
+    ConnectionLinks* links; // parallel to connections
+    int connectionCount;
+    int connectionCapacity;
+} Graph;
+
+bool graph_init(Graph* graph);
+void graph_destroy(Graph* graph);
+bool graph_reserve(Graph* graph, int nodeCapacity, int connectionCapacity);
+// Adds a default sized Variable node at (x, y), reusing a free slot if there is one.
+// Returns its index, or -1 if memory ran out.
+int graph_add_node(Graph* graph, float x, float y, const char* name);
+// Re-creates a node in a specific free slot, as undo does for a removed node. O(1) when the
+// slot is the most recently freed one, which it is when edits are undone in order; otherwise
+// the free list is searched. Handles taken before the removal stay stale. Returns index, or
+// -1 if that slot is not free.
+int graph_restore_node(Graph* graph, int index, float x, float y, const char* name);
+// Frees the node's slot. Connections touching it must be removed by the caller first,
+// e.g. by removing graph_first_out/graph_first_in until both are -1.
+void graph_remove_node(Graph* graph, int index);
+static inline bool graph_node_alive(const Graph* graph, int index) {
+    return index >= 0 && index < graph->nodeCount && graph->slots[index].alive;
+}
+NodeHandle graph_node_handle(const Graph* graph, int index);
+// Index of the node the handle refers to, or -1 if that node has been removed.
+int graph_node_resolve(const Graph* graph, NodeHandle handle);
+
+// Appends a connection into input slot toSlot of toNode. Returns its index, or -1 if memory
+// ran out.
+int graph_add_connection(Graph* graph, int fromNode, int toNode, int toSlot);
+// Removes a connection by moving the last one into its place. Returns true if a
+// connection was moved, in which case index now refers to it.
+bool graph_remove_connection(Graph* graph, int index);
+
+// Adjacency walks, O(degree). Iterate with
+//     for (int c = graph_first_out(graph, n); c != -1; c = graph_next_out(graph, c))
+// Removing connections while walking invalidates the walk.
+static inline int graph_first_out(const Graph* graph, int node) { return graph->slots[node].firstOut; }
+static inline int graph_next_out(const Graph* graph, int connection) { return graph->links[connection].nextOut; }
+static inline int graph_first_in(const Graph* graph, int node) { return graph->slots[node].firstIn; }
+static inline int graph_next_in(const Graph* graph, int connection) { return graph->links[connection].nextIn; }
+// The connection into an input slot, or -1. The editor allows one per slot, so a node's
+// incoming list is at most NODE_MAX_INPUTS long.
+static inline int graph_input_connection(const Graph* graph, int node, int slot) {
+    for (int c = graph->slots[node].firstIn; c != -1; c = graph->links[c].nextIn) {
+        if (graph->connections[c].toSlot == slot) return c;
+    }
+    return -1;
+}
+static inline bool graph_input_used(const Graph* graph, int node, int slot) { return graph_input_connection(graph, node, slot) != -1; }
+
+#endif
@@ -0,0 +1,264 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // mmap, open and fstat under strict C11
+#endif
+#include "graph_file.h"
+#include "mem.h"
+#include <stdio.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+bool graph_file_save(const Graph* graph, const char* path) {
+    // Slot indices are not stored; live nodes are renumbered in slot order.
+    int* fileIndex = mem_alloc((size_t)(graph->nodeCount > 0 ? graph->nodeCount : 1) * sizeof(int));
+    if (!fileIndex) {
+        printf("Failed to save %s: out of memory\n", path);
+        return false;
+    }
+    uint32_t nodeCount = 0, stringBytes = 0;
+    for (int i = 0; i < graph->nodeCount; i++) {
+        if (!graph_node_alive(graph, i)) continue;
+        fileIndex[i] = (int)nodeCount++;
+        stringBytes += (uint32_t)strlen(graph->nodes[i].name) + 1;
+    }
+
+    GraphFileHeader header = {0};
+    header.magic = GRAPH_FILE_MAGIC;
+    header.version = GRAPH_FILE_VERSION;
+    header.nodeCount = nodeCount;
+    header.connectionCount = (uint32_t)graph->connectionCount;
+    header.stringBytes = stringBytes;
+    header.nodesOffset = align8(sizeof(GraphFileHeader));
+    header.connectionsOffset = align8(header.nodesOffset + (uint64_t)nodeCount * sizeof(GraphFileNode));
+    header.stringsOffset = align8(header.connectionsOffset + (uint64_t)header.connectionCount * sizeof(GraphFileConnection));
+    size_t size = (size_t)(header.stringsOffset + stringBytes);
+
+    // The whole file is assembled in memory and written in one call.
+    unsigned char* buffer = mem_calloc(1, size);
+    if (!buffer) {
+        printf("Failed to save %s: cannot allocate %zu bytes\n", path, size);
+        mem_free(fileIndex);
+        return false;
+    }
+    memcpy(buffer, &header, sizeof(header));
+    GraphFileNode* nodes = (GraphFileNode*)(buffer + header.nodesOffset);
+    GraphFileConnection* connections = (GraphFileConnection*)(buffer + header.connectionsOffset);
+    char* strings = (char*)(buffer + header.stringsOffset);
+    uint32_t stringOffset = 0;
+    for (int i = 0; i < graph->nodeCount; i++) {
+        if (!graph_node_alive(graph, i)) continue;
+        const Node2D* node = &graph->nodes[i];
+        GraphFileNode* out = &nodes[fileIndex[i]];
+        out->x = node->x;
+        out->y = node->y;
+        out->width = node->width;
+        out->height = node->height;
+        out->type = (uint32_t)node->type;
+        out->value = node->value;
+        out->nameOffset = stringOffset;
+        out->nameLength = (uint32_t)strlen(node->name);
+        memcpy(strings + stringOffset, node->name, out->nameLength + 1);
+        stringOffset += out->nameLength + 1;
+    }
+    for (int c = 0; c < graph->connectionCount; c++) {
+        connections[c].fromNode = (uint32_t)fileIndex[graph->connections[c].fromNode];
+        connections[c].toNode = (uint32_t)fileIndex[graph->connections[c].toNode];
+        connections[c].toSlot = (uint32_t)graph->connections[c].toSlot;
+    }
+    mem_free(fileIndex);
+
+    FILE* out = fopen(path, "wb");
+    if (!out) {
+        printf("Failed to open %s for writing\n", path);
+        mem_free(buffer);
+        return false;
+    }
+    bool ok = fwrite(buffer, 1, size, out) == size;
+    if (fclose(out) != 0) ok = false;
+    mem_free(buffer);
+    if (!ok) printf("Failed to write %s\n", path);
+    return ok;
+}
+
+static bool map_file(GraphFile* file, const char* path) {
+#ifdef _WIN32
+    HANDLE fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(fileHandle, &size) || size.QuadPart == 0) {
+        CloseHandle(fileHandle);
+        return false;
+    }
+    HANDLE mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mappingHandle) {
+        CloseHandle(fileHandle);
+        return false;
+    }
+    void* mapping = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (!mapping) {
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        return false;
+    }
+    file->fileHandle = fileHandle;
+    file->mappingHandle = mappingHandle;
+    file->mapping = mapping;
+    file->size = (size_t)size.QuadPart;
+    return true;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void* mapping = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file referenced
+    if (mapping == MAP_FAILED) return false;
+    file->mapping = mapping;
+    file->size = (size_t)info.st_size;
+    return true;
+#endif
+}
+
+static bool table_fits(const GraphFile* file, uint64_t offset, uint64_t count, size_t itemSize) {
+    return offset % 8 == 0 && offset <= file->size && count <= (file->size - offset) / itemSize;
+}
+
+static bool validate(GraphFile* file, const char* path) {
+    if (file->size < sizeof(GraphFileHeader)) {
+        printf("%s: too short for a graph file\n", path);
+        return false;
+    }
+    const GraphFileHeader* header = file->mapping;
+    if (header->magic != GRAPH_FILE_MAGIC) {
+        printf("%s: not a graph file\n", path);
+        return false;
+    }
+    if (header->version != GRAPH_FILE_VERSION) {
+        printf("%s: unsupported graph file version %u\n", path, header->version);
+        return false;
+    }
+    if (header->nodeCount > INT32_MAX || header->connectionCount > INT32_MAX ||
+        !table_fits(file, header->nodesOffset, header->nodeCount, sizeof(GraphFileNode)) ||
+        !table_fits(file, header->connectionsOffset, header->connectionCount, sizeof(GraphFileConnection)) ||
+        header->stringsOffset > file->size || header->stringBytes > file->size - header->stringsOffset) {
+        printf("%s: tables run past the end of the file\n", path);
+        return false;
+    }
+
+    const unsigned char* base = file->mapping;
+    file->header = header;
+    file->nodes = (const GraphFileNode*)(base + header->nodesOffset);
+    file->connections = (const GraphFileConnection*)(base + header->connectionsOffset);
+    file->strings = (const char*)(base + header->stringsOffset);
+    for (uint32_t i = 0; i < header->nodeCount; i++) {
+        const GraphFileNode* node = &file->nodes[i];
+        if (node->nameOffset >= header->stringBytes || node->nameLength >= header->stringBytes - node->nameOffset ||
+            file->strings[node->nameOffset + node->nameLength] != '\0') {
+            printf("%s: node %u has a bad name\n", path, i);
+            return false;
+        }
+        if (node->type >= NODE_TYPE_COUNT) {
+            printf("%s: node %u has unknown type %u\n", path, i, node->type);
+            return false;
+        }
+    }
+    // One bit per input slot of each node, set once a connection goes into it.
+    unsigned char* inputsUsed = mem_calloc(header->nodeCount > 0 ? header->nodeCount : 1, 1);
+    if (!inputsUsed) {
+        printf("%s: out of memory checking %u nodes\n", path, header->nodeCount);
+        return false;
+    }
+    bool ok = true;
+    for (uint32_t c = 0; c < header->connectionCount && ok; c++) {
+        const GraphFileConnection* connection = &file->connections[c];
+        if (connection->fromNode >= header->nodeCount || connection->toNode >= header->nodeCount) {
+            printf("%s: connection %u points past the node table\n", path, c);
+            ok = false;
+        } else if (connection->toSlot >= (uint32_t)node_input_count((NodeType)file->nodes[connection->toNode].type)) {
+            printf("%s: connection %u goes into missing input %u\n", path, c, connection->toSlot);
+            ok = false;
+        } else if (inputsUsed[connection->toNode] & (1u << connection->toSlot)) {
+            printf("%s: connection %u goes into input %u of node %u, which is already connected\n", path, c,
+                   connection->toSlot, connection->toNode);
+            ok = false;
+        } else {
+            inputsUsed[connection->toNode] |= (unsigned char)(1u << connection->toSlot);
+        }
+    }
+    mem_free(inputsUsed);
+    return ok;
+}
+
+bool graph_file_open(GraphFile* file, const char* path) {
+    memset(file, 0, sizeof(*file));
+    if (!map_file(file, path)) {
+        printf("Failed to map %s\n", path);
+        return false;
+    }
+    if (!validate(file, path)) {
+        graph_file_close(file);
+        return false;
+    }
+    return true;
+}
+
+void graph_file_close(GraphFile* file) {
+    if (file->mapping) {
+#ifdef _WIN32
+        UnmapViewOfFile(file->mapping);
+        CloseHandle(file->mappingHandle);
+        CloseHandle(file->fileHandle);
+#else
+        munmap(file->mapping, file->size);
+#endif
+    }
+    memset(file, 0, sizeof(*file));
+}
+
+bool graph_file_read(const GraphFile* file, Graph* graph) {
+    int nodeCount = (int)file->header->nodeCount;
+    int connectionCount = (int)file->header->connectionCount;
+    int* slot = mem_alloc((size_t)(nodeCount > 0 ? nodeCount : 1) * sizeof(int));
+    if (!slot || !graph_reserve(graph, graph->nodeCount + nodeCount, graph->connectionCount + connectionCount)) {
+        printf("Failed to load graph: out of memory at %d nodes\n", nodeCount);
+        mem_free(slot);
+        return false;
+    }
+    for (int i = 0; i < nodeCount; i++) {
+        const GraphFileNode* in = &file->nodes[i];
+        slot[i] = graph_add_node(graph, in->x, in->y, file->strings + in->nameOffset);
+        Node2D* node = &graph->nodes[slot[i]];
+        node->width = in->width;
+        node->height = in->height;
+        node->type = (NodeType)in->type;
+        node->value = in->value;
+        node_update_slots(node);
+    }
+    for (int c = 0; c < connectionCount; c++) {
+        const GraphFileConnection* in = &file->connections[c];
+        graph_add_connection(graph, slot[in->fromNode], slot[in->toNode], (int)in->toSlot);
+    }
+    mem_free(slot);
+    return true;
+}
+
+bool graph_file_load(Graph* graph, const char* path) {
+    GraphFile file;
+    if (!graph_file_open(&file, path)) return false;
+    bool ok = graph_file_read(&file, graph);
+    graph_file_close(&file);
+    return ok;
+}
@@ -0,0 +1,73 @@
+#ifndef GRAPH_FILE_H
+#define GRAPH_FILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "graph.h"
+
+// Binary graph file, version GRAPH_FILE_VERSION. Layout, all little endian:
+//     GraphFileHeader
+//     GraphFileNode[nodeCount]             at nodesOffset
+//     GraphFileConnection[connectionCount] at connectionsOffset
+//     char[stringBytes]                    at stringsOffset, NUL terminated names
+// Tables start on 8 byte boundaries, so a mapped file can be read in place. Nodes are
+// stored compacted: connection endpoints are positions in the node table, not slot indices.
+#define GRAPH_FILE_MAGIC 0x4744324Eu // "N2DG"
+#define GRAPH_FILE_VERSION 2 // 2 added node types, values and input slots
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t nodeCount;
+    uint32_t connectionCount;
+    uint32_t stringBytes;
+    uint32_t reserved;
+    uint64_t nodesOffset;
+    uint64_t connectionsOffset;
+    uint64_t stringsOffset;
+} GraphFileHeader;
+
+typedef struct {
+    float x, y;
+    float width, height;
+    uint32_t nameOffset; // into the string pool
+    uint32_t nameLength; // without the terminator
+    uint32_t type;       // NodeType
+    float value;
+} GraphFileNode;
+
+typedef struct {
+    uint32_t fromNode;
+    uint32_t toNode;
+    uint32_t toSlot;
+} GraphFileConnection;
+
+// A validated, read-only view of a graph file mapped into memory. The tables point straight
+// into the mapping and stay valid until graph_file_close.
+typedef struct {
+    const GraphFileHeader* header;
+    const GraphFileNode* nodes;
+    const GraphFileConnection* connections;
+    const char* strings;
+    void* mapping;
+    size_t size;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+} GraphFile;
+
+// Writes the live nodes and all connections with a single buffered write. Returns false and
+// prints why on failure.
+bool graph_file_save(const Graph* graph, const char* path);
+// Maps the file and checks the header, table bounds, names, connection endpoints and that no
+// input is connected twice.
+bool graph_file_open(GraphFile* file, const char* path);
+void graph_file_close(GraphFile* file);
+// Appends the file's nodes and connections to the graph, copying out of the mapping.
+bool graph_file_read(const GraphFile* file, Graph* graph);
+// Opens the file, appends it to the graph and closes it.
+bool graph_file_load(Graph* graph, const char* path);
+
+#endif
@@ -0,0 +1,354 @@
+#include "graph_json.h"
+#include "mem.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Writer
+
+static void write_string(FILE* out, const char* s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            fputc('\\', out);
+            fputc(c, out);
+        } else if (c < 0x20) {
+            fprintf(out, "\\u%04x", c);
+        } else {
+            fputc(c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+bool graph_json_save(const Graph* graph, const char* path) {
+    FILE* out = fopen(path, "wb");
+    if (!out) {
+        printf("Failed to open %s for writing\n", path);
+        return false;
+    }
+    setvbuf(out, NULL, _IOFBF, JSON_BUFFER_SIZE);
+
+    // Live nodes are renumbered in slot order; connections refer to those positions.
+    int* position = mem_alloc((size_t)(graph->nodeCount > 0 ? graph->nodeCount : 1) * sizeof(int));
+    if (!position) {
+        printf("Failed to save %s: out of memory\n", path);
+        fclose(out);
+        return false;
+    }
+    fprintf(out, "{\"version\": %d,\n\"nodes\": [", GRAPH_JSON_VERSION);
+    int n = 0;
+    for (int i = 0; i < graph->nodeCount; i++) {
+        if (!graph_node_alive(graph, i)) continue;
+        const Node2D* node = &graph->nodes[i];
+        fputs(n ? ",\n{\"name\": " : "\n{\"name\": ", out);
+        write_string(out, node->name);
+        // %.9g round-trips every float exactly.
+        fprintf(out, ", \"type\": \"%s\", \"value\": %.9g, \"x\": %.9g, \"y\": %.9g, \"width\": %.9g, \"height\": %.9g}",
+                node_type_name(node->type), node->value, node->x, node->y, node->width, node->height);
+        position[i] = n++;
+    }
+    fputs("],\n\"connections\": [", out);
+    for (int c = 0; c < graph->connectionCount; c++) {
+        fprintf(out, "%s{\"from\": %d, \"to\": %d, \"slot\": %d}", c ? ",\n" : "\n",
+                position[graph->connections[c].fromNode], position[graph->connections[c].toNode],
+                graph->connections[c].toSlot);
+    }
+    fputs("]}\n", out);
+    mem_free(position);
+
+    bool ok = !ferror(out);
+    if (fclose(out) != 0) ok = false;
+    if (!ok) printf("Failed to write %s\n", path);
+    return ok;
+}
+
+// Tokenizer
+
+void json_reader_init(JsonReader* reader, FILE* file) {
+    reader->file = file;
+    reader->pos = reader->length = 0;
+    reader->line = 1;
+    reader->string[0] = '\0';
+    reader->number = 0.0;
+    reader->error[0] = '\0';
+}
+
+// Next input byte, or -1 at the end of the file.
+static int peek(JsonReader* reader) {
+    if (reader->pos == reader->length) {
+        reader->length = fread(reader->buffer, 1, sizeof(reader->buffer), reader->file);
+        reader->pos = 0;
+        if (reader->length == 0) return -1;
+    }
+    return (unsigned char)reader->buffer[reader->pos];
+}
+
+static int next_char(JsonReader* reader) {
+    int c = peek(reader);
+    if (c != -1) reader->pos++;
+    if (c == '\n') reader->line++;
+    return c;
+}
+
+static JsonToken fail(JsonReader* reader, const char* message) {
+    snprintf(reader->error, sizeof(reader->error), "line %ld: %s", reader->line, message);
+    return JSON_ERROR;
+}
+
+static bool match_word(JsonReader* reader, const char* rest) {
+    for (; *rest; rest++) {
+        if (next_char(reader) != *rest) return false;
+    }
+    return true;
+}
+
+static int hex_digit(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static JsonToken read_string(JsonReader* reader) {
+    size_t length = 0;
+    for (;;) {
+        int c = next_char(reader);
+        if (c == -1 || c == '\n') return fail(reader, "unterminated string");
+        if (c == '"') break;
+        if (c == '\\') {
+            c = next_char(reader);
+            switch (c) {
+            case '"': case '\\': case '/': break;
+            case 'b': c = '\b'; break;
+            case 'f': c = '\f'; break;
+            case 'n': c = '\n'; break;
+            case 'r': c = '\r'; break;
+            case 't': c = '\t'; break;
+            case 'u': {
+                int code = 0;
+                for (int i = 0; i < 4; i++) {
+                    int digit = hex_digit(next_char(reader));
+                    if (digit < 0) return fail(reader, "bad \\u escape");
+                    code = code * 16 + digit;
+                }
+                // Names are plain text; anything outside ASCII is stored as '?'.
+                c = code < 0x80 ? code : '?';
+                break;
+            }
+            default:
+                return fail(reader, "bad escape");
+            }
+        }
+        if (length + 1 < sizeof(reader->string)) reader->string[length++] = (char)c;
+    }
+    reader->string[length] = '\0';
+    return JSON_STRING;
+}
+
+static JsonToken read_number(JsonReader* reader) {
+    char text[64];
+    size_t length = 0;
+    for (;;) {
+        int c = peek(reader);
+        if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) break;
+        if (length + 1 >= sizeof(text)) return fail(reader, "number too long");
+        text[length++] = (char)next_char(reader);
+    }
+    text[length] = '\0';
+    char* end;
+    reader->number = strtod(text, &end);
+    if (length == 0 || *end != '\0') return fail(reader, "bad number");
+    return JSON_NUMBER;
+}
+
+JsonToken json_next(JsonReader* reader) {
+    for (;;) {
+        int c = peek(reader);
+        switch (c) {
+        case -1: return ferror(reader->file) ? fail(reader, "read error") : JSON_END;
+        case ' ': case '\t': case '\r': case '\n': case ',': case ':':
+            next_char(reader);
+            continue;
+        case '{': next_char(reader); return JSON_BEGIN_OBJECT;
+        case '}': next_char(reader); return JSON_END_OBJECT;
+        case '[': next_char(reader); return JSON_BEGIN_ARRAY;
+        case ']': next_char(reader); return JSON_END_ARRAY;
+        case '"': next_char(reader); return read_string(reader);
+        case 't': return match_word(reader, "true") ? JSON_TRUE : fail(reader, "bad literal");
+        case 'f': return match_word(reader, "false") ? JSON_FALSE : fail(reader, "bad literal");
+        case 'n': return match_word(reader, "null") ? JSON_NULL : fail(reader, "bad literal");
+        default:
+            if (c == '-' || (c >= '0' && c <= '9')) return read_number(reader);
+            return fail(reader, "unexpected character");
+        }
+    }
+}
+
+bool json_skip(JsonReader* reader, JsonToken first) {
+    if (first != JSON_BEGIN_OBJECT && first != JSON_BEGIN_ARRAY) return first != JSON_ERROR && first != JSON_END;
+    int depth = 1;
+    while (depth > 0) {
+        JsonToken token = json_next(reader);
+        if (token == JSON_ERROR || token == JSON_END) return false;
+        if (token == JSON_BEGIN_OBJECT || token == JSON_BEGIN_ARRAY) depth++;
+        else if (token == JSON_END_OBJECT || token == JSON_END_ARRAY) depth--;
+    }
+    return true;
+}
+
+// Loader
+
+typedef struct {
+    JsonReader reader;
+    Graph* graph;
+    int* slots; // graph slot of each node read so far, by position in the file
+    int slotCount, slotCapacity;
+} JsonLoad;
+
+static bool load_error(JsonLoad* load, const char* message) {
+    if (!load->reader.error[0]) {
+        snprintf(load->reader.error, sizeof(load->reader.error), "line %ld: %s", load->reader.line, message);
+    }
+    return false;
+}
+
+static bool read_number_value(JsonLoad* load, float* value) {
+    if (json_next(&load->reader) != JSON_NUMBER) return load_error(load, "expected a number");
+    *value = (float)load->reader.number;
+    return true;
+}
+
+static bool read_index_value(JsonLoad* load, int* value) {
+    if (json_next(&load->reader) != JSON_NUMBER) return load_error(load, "expected a number");
+    double number = load->reader.number;
+    *value = number >= 0.0 && number < 2147483647.0 ? (int)number : -1;
+    return true;
+}
+
+static bool read_type_value(JsonLoad* load, NodeType* type) {
+    if (json_next(&load->reader) != JSON_STRING) return load_error(load, "expected a type name");
+    for (int t = 0; t < NODE_TYPE_COUNT; t++) {
+        if (strcmp(load->reader.string, node_type_name((NodeType)t)) == 0) {
+            *type = (NodeType)t;
+            return true;
+        }
+    }
+    return load_error(load, "unknown node type");
+}
+
+static bool read_node(JsonLoad* load) {
+    char name[32] = "";
+    float x = 0.0f, y = 0.0f, width = NODE_WIDTH, height = NODE_HEIGHT, value = 0.0f;
+    NodeType type = NODE_VARIABLE;
+    JsonToken token;
+    while ((token = json_next(&load->reader)) == JSON_STRING) {
+        bool ok;
+        if (strcmp(load->reader.string, "name") == 0) {
+            ok = json_next(&load->reader) == JSON_STRING;
+            if (ok) snprintf(name, sizeof(name), "%.31s", load->reader.string);
+        }
+        else if (strcmp(load->reader.string, "type") == 0) ok = read_type_value(load, &type);
+        else if (strcmp(load->reader.string, "value") == 0) ok = read_number_value(load, &value);
+        else if (strcmp(load->reader.string, "x") == 0) ok = read_number_value(load, &x);
+        else if (strcmp(load->reader.string, "y") == 0) ok = read_number_value(load, &y);
+        else if (strcmp(load->reader.string, "width") == 0) ok = read_number_value(load, &width);
+        else if (strcmp(load->reader.string, "height") == 0) ok = read_number_value(load, &height);
+        else ok = json_skip(&load->reader, json_next(&load->reader));
+        if (!ok) return load_error(load, "bad node field");
+    }
+    if (token != JSON_END_OBJECT) return load_error(load, "expected a node field");
+
+    if (load->slotCount == load->slotCapacity) {
+        int newCapacity = load->slotCapacity ? load->slotCapacity * 2 : 1024;
+        int* slots = mem_realloc(load->slots, (size_t)newCapacity * sizeof(int));
+        if (!slots) return load_error(load, "out of memory");
+        load->slots = slots;
+        load->slotCapacity = newCapacity;
+    }
+    int slot = graph_add_node(load->graph, x, y, name);
+    if (slot == -1) return load_error(load, "out of memory");
+    Node2D* node = &load->graph->nodes[slot];
+    node->width = width;
+    node->height = height;
+    node->type = type;
+    node->value = value;
+    node_update_slots(node);
+    load->slots[load->slotCount++] = slot;
+    return true;
+}
+
+static bool read_connection(JsonLoad* load) {
+    int fromNode = -1, toNode = -1, toSlot = 0;
+    JsonToken token;
+    while ((token = json_next(&load->reader)) == JSON_STRING) {
+        bool ok;
+        if (strcmp(load->reader.string, "from") == 0) ok = read_index_value(load, &fromNode);
+        else if (strcmp(load->reader.string, "to") == 0) ok = read_index_value(load, &toNode);
+        else if (strcmp(load->reader.string, "slot") == 0) ok = read_index_value(load, &toSlot);
+        else ok = json_skip(&load->reader, json_next(&load->reader));
+        if (!ok) return load_error(load, "bad connection field");
+    }
+    if (token != JSON_END_OBJECT) return load_error(load, "expected a connection field");
+    if (fromNode < 0 || fromNode >= load->slotCount || toNode < 0 || toNode >= load->slotCount) {
+        return load_error(load, "connection refers to a node that was not listed before it");
+    }
+    if (toSlot < 0 || toSlot >= node_input_count(load->graph->nodes[load->slots[toNode]].type)) {
+        return load_error(load, "connection goes into a missing input");
+    }
+    if (graph_input_used(load->graph, load->slots[toNode], toSlot)) {
+        return load_error(load, "connection goes into an input that is already connected");
+    }
+    if (graph_add_connection(load->graph, load->slots[fromNode], load->slots[toNode], toSlot) == -1) {
+        return load_error(load, "out of memory");
+    }
+    return true;
+}
+
+static bool read_array(JsonLoad* load, bool (*read_item)(JsonLoad*)) {
+    if (json_next(&load->reader) != JSON_BEGIN_ARRAY) return load_error(load, "expected an array");
+    JsonToken token;
+    while ((token = json_next(&load->reader)) == JSON_BEGIN_OBJECT) {
+        if (!read_item(load)) return false;
+    }
+    return token == JSON_END_ARRAY || load_error(load, "expected an object");
+}
+
+static bool read_graph(JsonLoad* load) {
+    if (json_next(&load->reader) != JSON_BEGIN_OBJECT) return load_error(load, "expected an object");
+    JsonToken token;
+    while ((token = json_next(&load->reader)) == JSON_STRING) {
+        bool ok;
+        if (strcmp(load->reader.string, "version") == 0) {
+            ok = json_next(&load->reader) == JSON_NUMBER;
+            if (ok && load->reader.number > GRAPH_JSON_VERSION) return load_error(load, "unsupported version");
+        }
+        else if (strcmp(load->reader.string, "nodes") == 0) ok = read_array(load, read_node);
+        else if (strcmp(load->reader.string, "connections") == 0) ok = read_array(load, read_connection);
+        else ok = json_skip(&load->reader, json_next(&load->reader));
+        if (!ok) return load_error(load, "bad graph field");
+    }
+    return token == JSON_END_OBJECT || load_error(load, "expected a graph field");
+}
+
+bool graph_json_load(Graph* graph, const char* path) {
+    FILE* in = fopen(path, "rb");
+    if (!in) {
+        printf("Failed to open %s\n", path);
+        return false;
+    }
+    JsonLoad* load = mem_calloc(1, sizeof(JsonLoad)); // the read buffer is too big for the stack
+    if (!load) {
+        printf("Failed to load %s: out of memory\n", path);
+        fclose(in);
+        return false;
+    }
+    json_reader_init(&load->reader, in);
+    load->graph = graph;
+    bool ok = read_graph(load);
+    if (!ok) printf("%s: %s\n", path, load->reader.error);
+    mem_free(load->slots);
+    mem_free(load);
+    fclose(in);
+    return ok;
+}
@@ -0,0 +1,62 @@
+#ifndef GRAPH_JSON_H
+#define GRAPH_JSON_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "graph.h"
+
+// Text exchange format, written and read in a single streaming pass:
+//     {"version": 2,
+//     "nodes": [
+//     {"name": "Node 0", "type": "Variable", "value": 0, "x": 0, "y": 0, "width": 100, "height": 100},
+//     {"name": "Node 1", "type": "Add", "value": 0, "x": 150, "y": 0, "width": 100, "height": 100}],
+//     "connections": [
+//     {"from": 0, "to": 1, "slot": 0}]}
+// Connection endpoints are positions in the "nodes" array, which must come first; slot is the
+// input of the "to" node, and each input takes at most one connection. Unknown keys are
+// skipped, missing fields take their defaults, so version 1 files (no types, values or
+// slots) load as Variable nodes with every connection into slot 0.
+#define GRAPH_JSON_VERSION 2
+#define JSON_BUFFER_SIZE 65536
+#define JSON_MAX_STRING 256 // longer strings are truncated; names are shorter still
+
+typedef enum {
+    JSON_BEGIN_OBJECT,
+    JSON_END_OBJECT,
+    JSON_BEGIN_ARRAY,
+    JSON_END_ARRAY,
+    JSON_STRING,
+    JSON_NUMBER,
+    JSON_TRUE,
+    JSON_FALSE,
+    JSON_NULL,
+    JSON_END,  // end of input
+    JSON_ERROR
+} JsonToken;
+
+// Pull tokenizer over a file. Memory is the fixed read buffer plus one string, whatever the
+// size of the input. Object keys are returned as JSON_STRING tokens; commas and colons are
+// consumed between tokens, so the caller checks the structure it expects.
+typedef struct {
+    FILE* file;
+    char buffer[JSON_BUFFER_SIZE];
+    size_t pos, length;
+    long line;
+    char string[JSON_MAX_STRING]; // value of the last JSON_STRING
+    double number;                // value of the last JSON_NUMBER
+    char error[96];
+} JsonReader;
+
+void json_reader_init(JsonReader* reader, FILE* file);
+JsonToken json_next(JsonReader* reader);
+// Consumes the rest of a value whose first token has already been read.
+bool json_skip(JsonReader* reader, JsonToken first);
+
+// Streams the live nodes and all connections to the file. Returns false and prints why on
+// failure.
+bool graph_json_save(const Graph* graph, const char* path);
+// Appends the nodes and connections of a JSON graph file, adding them as they are parsed.
+// On a parse error the graph keeps what was read so far.
+bool graph_json_load(Graph* graph, const char* path);
+
+#endif
@@ -0,0 +1,134 @@
+#include "hit_test.h"
+#include <math.h>
+
+bool hit_test_init(HitTest* hitTest) {
+    if (!spatial_grid_init(&hitTest->nodeGrid, SPATIAL_CELL_SIZE)) return false;
+    if (!spatial_grid_init(&hitTest->wireGrid, SPATIAL_CELL_SIZE)) {
+        spatial_grid_destroy(&hitTest->nodeGrid);
+        return false;
+    }
+    return true;
+}
+
+void hit_test_destroy(HitTest* hitTest) {
+    spatial_grid_destroy(&hitTest->nodeGrid);
+    spatial_grid_destroy(&hitTest->wireGrid);
+}
+
+void hit_test_update_node(HitTest* hitTest, const Node2D* nodes, int index) {
+    float minX, minY, maxX, maxY;
+    node_bounds(&nodes[index], &minX, &minY, &maxX, &maxY);
+    spatial_grid_update(&hitTest->nodeGrid, index, minX, minY, maxX, maxY);
+}
+
+void hit_test_remove_node(HitTest* hitTest, int index) {
+    spatial_grid_remove(&hitTest->nodeGrid, index);
+}
+
+void hit_test_update_wire(HitTest* hitTest, const Node2D* nodes, const Connection* connections, int index) {
+    const Node2D* from = &nodes[connections[index].fromNode];
+    const Node2D* to = &nodes[connections[index].toNode];
+    float minX, minY, maxX, maxY;
+    wire_bounds(from->outputX, from->outputY, to->inputX, to->inputY[connections[index].toSlot], &minX, &minY, &maxX, &maxY);
+    spatial_grid_update(&hitTest->wireGrid, index, minX, minY, maxX, maxY);
+}
+
+void hit_test_remove_wire(HitTest* hitTest, int index) {
+    spatial_grid_remove(&hitTest->wireGrid, index);
+}
+
+int hit_test_header(HitTest* hitTest, const Node2D* nodes, float worldX, float worldY) {
+    const int* ids;
+    int count = spatial_grid_query(&hitTest->nodeGrid, worldX, worldY, worldX, worldY, &ids);
+    for (int k = count - 1; k >= 0; k--) {
+        const Node2D* node = &nodes[ids[k]];
+        if (worldX >= node->x && worldX <= node->x + node->width &&
+            worldY >= node->y && worldY <= node->y + HEADER_HEIGHT) {
+            return ids[k];
+        }
+    }
+    return -1;
+}
+
+int hit_test_node(HitTest* hitTest, const Node2D* nodes, float worldX, float worldY) {
+    const int* ids;
+    int count = spatial_grid_query(&hitTest->nodeGrid, worldX, worldY, worldX, worldY, &ids);
+    for (int k = count - 1; k >= 0; k--) {
+        const Node2D* node = &nodes[ids[k]];
+        if (worldX >= node->x && worldX <= node->x + node->width &&
+            worldY >= node->y && worldY <= node->y + node->height) {
+            return ids[k];
+        }
+    }
+    return -1;
+}
+
+int hit_test_output_slot(HitTest* hitTest, const Node2D* nodes, float worldX, float worldY, float radius) {
+    const int* ids;
+    int count = spatial_grid_query(&hitTest->nodeGrid, worldX - radius, worldY - radius,
+                                   worldX + radius, worldY + radius, &ids);
+    for (int k = 0; k < count; k++) {
+        float dx = worldX - nodes[ids[k]].outputX;
+        float dy = worldY - nodes[ids[k]].outputY;
+        if (dx * dx + dy * dy <= radius * radius) return ids[k];
+    }
+    return -1;
+}
+
+int hit_test_input_slot(HitTest* hitTest, const Node2D* nodes, float worldX, float worldY, float radius, int excludeNode,
+                        int* slot) {
+    const int* ids;
+    int count = spatial_grid_query(&hitTest->nodeGrid, worldX - radius, worldY - radius,
+                                   worldX + radius, worldY + radius, &ids);
+    for (int k = 0; k < count; k++) {
+        if (ids[k] == excludeNode) continue;
+        const Node2D* node = &nodes[ids[k]];
+        for (int s = 0; s < node_input_count(node->type); s++) {
+            float dx = worldX - node->inputX;
+            float dy = worldY - node->inputY[s];
+            if (dx * dx + dy * dy <= radius * radius) {
+                *slot = s;
+                return ids[k];
+            }
+        }
+    }
+    return -1;
+}
+
+int hit_test_wire(HitTest* hitTest, const Node2D* nodes, const Connection* connections,
+                  float worldX, float worldY, float maxDistance) {
+    const int* ids;
+    int count = spatial_grid_query(&hitTest->wireGrid, worldX - maxDistance, worldY - maxDistance,
+                                   worldX + maxDistance, worldY + maxDistance, &ids);
+    int best = -1;
+    float bestDistSq = maxDistance * maxDistance;
+    for (int k = 0; k < count; k++) {
+        const Connection* c = &connections[ids[k]];
+        float x1 = nodes[c->fromNode].outputX;
+        float y1 = nodes[c->fromNode].outputY;
+        float x2 = nodes[c->toNode].inputX;
+        float y2 = nodes[c->toNode].inputY[c->toSlot];
+
+        // Distance to the curve, approximated by a fixed polyline along it.
+        float ax = x1, ay = y1;
+        for (int s = 1; s <= WIRE_PICK_SEGMENTS; s++) {
+            float bx, by;
+            wire_point(x1, y1, x2, y2, (float)s / WIRE_PICK_SEGMENTS, &bx, &by);
+            float dx = bx - ax;
+            float dy = by - ay;
+            float len_sq = dx * dx + dy * dy;
+            float t = len_sq > 0 ? ((worldX - ax) * dx + (worldY - ay) * dy) / len_sq : 0;
+            t = fmaxf(0, fminf(1, t));
+            float projX = ax + t * dx;
+            float projY = ay + t * dy;
+            float distSq = (worldX - projX) * (worldX - projX) + (worldY - projY) * (worldY - projY);
+            if (distSq <= bestDistSq) {
+                bestDistSq = distSq;
+                best = ids[k];
+            }
+            ax = bx;
+            ay = by;
+        }
+    }
+    return best;
+}
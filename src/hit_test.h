@@ -0,0 +1,36 @@
+#ifndef HIT_TEST_H
+#define HIT_TEST_H
+
+#include <stdbool.h>
+#include "node2d.h"
+#include "spatial_grid.h"
+
+// Picking for node headers, slots and connection wires. Nodes and wire curves are kept in
+// spatial grids, so a pick only looks at the few items in the cells around the cursor.
+typedef struct {
+    SpatialGrid nodeGrid; // node bounds, also used for viewport culling
+    SpatialGrid wireGrid; // bounding boxes of the control points of connection curves
+} HitTest;
+
+bool hit_test_init(HitTest* hitTest);
+void hit_test_destroy(HitTest* hitTest);
+
+void hit_test_update_node(HitTest* hitTest, const Node2D* nodes, int index);
+void hit_test_remove_node(HitTest* hitTest, int index);
+void hit_test_update_wire(HitTest* hitTest, const Node2D* nodes, const Connection* connections, int index);
+void hit_test_remove_wire(HitTest* hitTest, int index);
+
+// Topmost node whose header contains the point, or -1.
+int hit_test_header(HitTest* hitTest, const Node2D* nodes, float worldX, float worldY);
+// Topmost node whose body or header contains the point, or -1.
+int hit_test_node(HitTest* hitTest, const Node2D* nodes, float worldX, float worldY);
+// Lowest-indexed node whose output/input slot is within radius of the point, or -1. The input
+// pick also returns which of the node's inputs was hit.
+int hit_test_output_slot(HitTest* hitTest, const Node2D* nodes, float worldX, float worldY, float radius);
+int hit_test_input_slot(HitTest* hitTest, const Node2D* nodes, float worldX, float worldY, float radius, int excludeNode,
+                        int* slot);
+// Closest connection within maxDistance of the point, or -1.
+int hit_test_wire(HitTest* hitTest, const Node2D* nodes, const Connection* connections,
+                  float worldX, float worldY, float maxDistance);
+
+#endif
@@ -0,0 +1,42 @@
+#include "hud.h"
+#include <stdio.h>
+#include <string.h>
+
+#define HUD_MARGIN 10.0f
+
+bool hud_init(Hud* hud) {
+    memset(hud->lines, 0, sizeof(hud->lines));
+    return text_batch_init(&hud->batch);
+}
+
+void hud_destroy(Hud* hud) {
+    text_batch_destroy(&hud->batch);
+}
+
+void hud_draw(Hud* hud, StreamBuffer* stream, const TextAtlas* atlas, const HudStatus* status, float viewWidth, float viewHeight) {
+    char lines[HUD_LINES][HUD_LINE_LENGTH] = {{0}}; // zeroed past each string, so the compare sees only text
+    snprintf(lines[0], HUD_LINE_LENGTH, "Camera: (%.0f, %.0f) Zoom: %.2f Snap: %s",
+             status->cameraX, status->cameraY, status->zoom, status->snapping ? "ON" : "OFF");
+    snprintf(lines[1], HUD_LINE_LENGTH, "Nodes: %d Links: %d Frame: %.1f ms",
+             status->nodeCount, status->connectionCount, status->frameMs);
+    snprintf(lines[2], HUD_LINE_LENGTH, "Frames: %d drawn %d skipped", status->framesRendered, status->framesSkipped);
+    snprintf(lines[3], HUD_LINE_LENGTH, "Autosaves: %d Snapshot: %.2f ms Write: %.1f ms",
+             status->autosaves, status->snapshotMs, status->writeMs);
+    snprintf(lines[4], HUD_LINE_LENGTH, "Eval: %d nodes %.2f ms on %d threads Cycles: %d New: %s",
+             status->evaluated, status->evalMs, status->evalThreads, status->cyclicNodes, status->addTypeName);
+    snprintf(lines[5], HUD_LINE_LENGTH, "Heap: %d calls last frame Scratch: %zu of %zu KB Stream: %s %zu of %zu KB",
+             status->heapCalls, status->scratchPeak / 1024, status->scratchCapacity / 1024, status->streamMode,
+             status->streamPeak / 1024, status->streamCapacity / 1024);
+
+    if (memcmp(lines, hud->lines, sizeof(lines)) != 0) {
+        memcpy(hud->lines, lines, sizeof(lines));
+        text_batch_begin(&hud->batch);
+        for (int i = 0; i < HUD_LINES; i++) {
+            text_batch_add(&hud->batch, atlas, hud->lines[i], HUD_MARGIN, HUD_MARGIN + atlas->lineHeight * i, 1.0f);
+        }
+    }
+
+    // Screen space: an identity camera maps pixels straight through.
+    Camera screen = {0.0f, 0.0f, 1.0f};
+    text_batch_draw(&hud->batch, stream, atlas, &screen, viewWidth, viewHeight, 1.0f, 1.0f, 1.0f);
+}
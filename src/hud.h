@@ -0,0 +1,49 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "text_atlas.h"
+
+#define HUD_LINES 6
+#define HUD_LINE_LENGTH 96
+
+// Values shown in the status overlay.
+typedef struct {
+    float cameraX, cameraY;
+    float zoom;
+    bool snapping;
+    int nodeCount;
+    int connectionCount;
+    float frameMs;
+    int framesRendered;
+    int framesSkipped;
+    int autosaves;
+    float snapshotMs;
+    float writeMs;
+    int evaluated; // nodes recomputed for this frame
+    float evalMs;
+    int cyclicNodes;
+    const char* addTypeName;
+    int evalThreads;
+    int heapCalls;          // allocations and reallocations during the last frame
+    size_t scratchPeak;     // most of the frame scratch arena ever used
+    size_t scratchCapacity;
+    const char* streamMode;  // how vertex data reaches the GPU
+    size_t streamPeak;       // most vertex data written in one frame
+    size_t streamCapacity;   // per frame, before the stream grows
+} HudStatus;
+
+// Status overlay in the top-left corner, drawn from the shared glyph atlas. Lines are
+// formatted into fixed buffers and only laid out again when their text changes; a frame
+// costs a few KB copied into the vertex stream and never touches a texture.
+typedef struct {
+    TextBatch batch;
+    char lines[HUD_LINES][HUD_LINE_LENGTH];
+} Hud;
+
+bool hud_init(Hud* hud);
+void hud_destroy(Hud* hud);
+void hud_draw(Hud* hud, StreamBuffer* stream, const TextAtlas* atlas, const HudStatus* status, float viewWidth, float viewHeight);
+
+#endif
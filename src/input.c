@@ -0,0 +1,50 @@
+#include "input.h"
+#include "mem.h"
+#include <stdio.h>
+#include <string.h>
+
+bool input_frame_init(InputFrame* frame) {
+    memset(frame, 0, sizeof(*frame));
+    frame->capacity = 64;
+    frame->events = mem_alloc(frame->capacity * sizeof(SDL_Event));
+    return frame->events != NULL;
+}
+
+void input_frame_destroy(InputFrame* frame) {
+    mem_free(frame->events);
+    memset(frame, 0, sizeof(*frame));
+}
+
+void input_frame_begin(InputFrame* frame) {
+    frame->count = 0;
+    frame->received = 0;
+}
+
+void input_frame_push(InputFrame* frame, const SDL_Event* event) {
+    frame->received++;
+    if (event->type == SDL_EVENT_QUIT) frame->quit = true;
+
+    if (event->type == SDL_EVENT_MOUSE_MOTION && frame->count > 0) {
+        SDL_MouseMotionEvent* last = &frame->events[frame->count - 1].motion;
+        if (last->type == SDL_EVENT_MOUSE_MOTION && last->which == event->motion.which) {
+            float xrel = last->xrel + event->motion.xrel;
+            float yrel = last->yrel + event->motion.yrel;
+            *last = event->motion;
+            last->xrel = xrel;
+            last->yrel = yrel;
+            return;
+        }
+    }
+
+    if (frame->count == frame->capacity) {
+        int newCapacity = frame->capacity * 2;
+        SDL_Event* grown = mem_realloc(frame->events, newCapacity * sizeof(SDL_Event));
+        if (!grown) {
+            printf("Dropping input event: out of memory at %d events\n", frame->count);
+            return;
+        }
+        frame->events = grown;
+        frame->capacity = newCapacity;
+    }
+    frame->events[frame->count++] = *event;
+}
@@ -0,0 +1,25 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+// Events gathered for one frame, in arrival order. A mouse-motion event that directly
+// follows another is merged into it: the merged event keeps the latest position and button
+// state and the summed relative motion. A high-rate mouse then costs one drag or pan update
+// per frame instead of one per report, while clicks and keys still see the pointer exactly
+// where it was when they happened.
+typedef struct {
+    SDL_Event* events;
+    int count;
+    int capacity;
+    int received; // events pushed since input_frame_begin, before merging
+    bool quit;
+} InputFrame;
+
+bool input_frame_init(InputFrame* frame);
+void input_frame_destroy(InputFrame* frame);
+void input_frame_begin(InputFrame* frame);
+void input_frame_push(InputFrame* frame, const SDL_Event* event);
+
+#endif
@@ -0,0 +1,238 @@
+// Headless batch runner: streams rows of an input file through a saved graph and reports the
+// throughput. The graph's outputs are the nodes nothing reads.
+//
+// Usage: node2d_batch <graph.n2d|graph.json> <input.csv|input.f32> [output.csv|output.f32]
+//
+// A .csv input holds one row per line, values separated by commas. If it starts with a header
+// line, each column feeds the Variable of that name, which must have no input connection, and
+// the other Variables keep their values. Without a header, and for any other input, which is
+// raw native-endian 32 bit floats row after row, every Variable without an input connection
+// takes one column, in node order. Outputs are written the same way, chosen by the output
+// file's extension.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "graph.h"
+#include "graph_file.h"
+#include "graph_json.h"
+#include "eval.h"
+#include "bytecode.h"
+#include "batch_eval.h"
+
+#define LINE_SIZE 65536
+
+typedef struct {
+    FILE* file;
+    bool csv;
+    char* line; // CSV line buffer, LINE_SIZE bytes
+    long lineNumber;
+    bool pending; // line holds a row not yet returned
+    bool error;   // a line was too long; the rest of the file is not read
+} RowReader;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static bool has_extension(const char* path, const char* extension) {
+    size_t length = strlen(path), extensionLength = strlen(extension);
+    return length >= extensionLength && strcmp(path + length - extensionLength, extension) == 0;
+}
+
+static bool read_line(RowReader* reader) {
+    if (!fgets(reader->line, LINE_SIZE, reader->file)) return false;
+    reader->lineNumber++;
+    if (strchr(reader->line, '\n') == NULL && !feof(reader->file)) {
+        printf("Line %ld is longer than %d characters\n", reader->lineNumber, LINE_SIZE - 2);
+        reader->error = true;
+        return false;
+    }
+    return true;
+}
+
+static bool is_free_variable(const Graph* graph, const Evaluator* eval, int node) {
+    return graph_node_alive(graph, node) && eval_has_value(eval, node) && graph->nodes[node].type == NODE_VARIABLE &&
+           !graph_input_used(graph, node, 0);
+}
+
+// Finds the inputs named by the CSV header, if the first line is one. Returns the number of
+// inputs, 0 if there is no header, or -1 if a column names no free Variable.
+static int read_header(RowReader* reader, const Graph* graph, const Evaluator* eval, int* inputs) {
+    if (!read_line(reader)) return reader->error ? -1 : 0;
+    // Numbers only if the whole first field parses, so a column named "nanos" or "2nd" is a name.
+    char* end;
+    strtof(reader->line, &end);
+    if (end != reader->line) end += strspn(end, " \t");
+    if (end != reader->line && strchr(",\r\n", *end)) {
+        reader->pending = true; // numbers: the first row
+        return 0;
+    }
+    int count = 0;
+    for (char* field = strtok(reader->line, ",\r\n"); field; field = strtok(NULL, ",\r\n")) {
+        field += strspn(field, " \t");
+        size_t length = strlen(field);
+        while (length > 0 && (field[length - 1] == ' ' || field[length - 1] == '\t')) field[--length] = '\0';
+        int node = 0;
+        while (node < graph->nodeCount && !(is_free_variable(graph, eval, node) && strcmp(graph->nodes[node].name, field) == 0)) {
+            node++;
+        }
+        if (node == graph->nodeCount) {
+            printf("Column \"%s\" names no Variable without an input\n", field);
+            return -1;
+        }
+        inputs[count++] = node;
+    }
+    return count;
+}
+
+// Parses count comma separated values. Returns false if the line holds fewer.
+static bool parse_csv_row(const char* line, float* values, int count) {
+    const char* p = line;
+    for (int i = 0; i < count; i++) {
+        char* end;
+        values[i] = strtof(p, &end);
+        if (end == p) return false;
+        p = end;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == ',') p++;
+    }
+    return true;
+}
+
+// Reads up to BATCH_SIZE rows of count values into rows, row-major. Returns the number read,
+// or -1 on a malformed or over-long line.
+static int read_rows(RowReader* reader, float* rows, int count) {
+    if (!reader->csv) return (int)fread(rows, sizeof(float) * (size_t)count, BATCH_SIZE, reader->file);
+    if (reader->error) return -1;
+    int read = 0;
+    while (read < BATCH_SIZE && (reader->pending || read_line(reader))) {
+        reader->pending = false;
+        if (strspn(reader->line, " \t\r\n") == strlen(reader->line)) continue;
+        if (!parse_csv_row(reader->line, rows + (size_t)read * count, count)) {
+            printf("Line %ld: expected %d values\n", reader->lineNumber, count);
+            return -1;
+        }
+        read++;
+    }
+    return reader->error || ferror(reader->file) || (!feof(reader->file) && read == 0) ? -1 : read;
+}
+
+static void write_csv_header(FILE* file, const Graph* graph, const BytecodeProgram* program) {
+    for (int o = 0; o < program->outputCount; o++) {
+        fprintf(file, "%s%s", o ? "," : "", graph->nodes[program->outputNodes[o]].name);
+    }
+    fputc('\n', file);
+}
+
+static void write_rows(FILE* file, bool csv, const float* rows, int rowCount, int count) {
+    if (!csv) {
+        fwrite(rows, sizeof(float) * (size_t)count, (size_t)rowCount, file);
+        return;
+    }
+    for (int r = 0; r < rowCount; r++) {
+        for (int o = 0; o < count; o++) fprintf(file, "%s%.9g", o ? "," : "", rows[(size_t)r * count + o]);
+        fputc('\n', file);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printf("Usage: %s <graph.n2d|graph.json> <input.csv|input.f32> [output.csv|output.f32]\n", argv[0]);
+        return 1;
+    }
+    Graph graph;
+    Evaluator eval;
+    if (!graph_init(&graph) || !eval_init(&eval)) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    bool loaded = has_extension(argv[1], ".json") ? graph_json_load(&graph, argv[1]) : graph_file_load(&graph, argv[1]);
+    if (!loaded || !eval_compile(&eval, &graph)) return 1;
+
+    RowReader reader = {fopen(argv[2], "rb"), has_extension(argv[2], ".csv"), malloc(LINE_SIZE), 0, false, false};
+    if (!reader.file) {
+        printf("Failed to open %s\n", argv[2]);
+        return 1;
+    }
+    int* inputs = malloc(((size_t)graph.nodeCount + 1) * sizeof(int));
+    if (!inputs || !reader.line) return 1;
+    int inputCount = reader.csv ? read_header(&reader, &graph, &eval, inputs) : 0;
+    if (inputCount < 0) return 1;
+    if (inputCount == 0) {
+        for (int n = 0; n < graph.nodeCount; n++) {
+            if (is_free_variable(&graph, &eval, n)) inputs[inputCount++] = n;
+        }
+    }
+    BytecodeProgram program;
+    if (!bytecode_compile(&program, &eval, &graph, inputs, inputCount, NULL, 0)) return 1;
+    printf("graph=%s nodes=%d inputs=%d outputs=%d instructions=%d folded=%d dead=%d cyclic=%d\n", argv[1],
+           graph.liveNodeCount, inputCount, program.outputCount, program.codeLength, program.foldedCount,
+           program.deadCount, eval.cyclicCount);
+
+    // Everything a batch needs, allocated once and reused for every batch.
+    int width = inputCount > program.outputCount ? inputCount : program.outputCount;
+    size_t rowBytes = (size_t)BATCH_SIZE * (width > 0 ? width : 1) * sizeof(float);
+    Arena arena;
+    BatchEvaluator batch;
+    if (!arena_init(&arena, batch_arena_bytes(&program) + arena_size(rowBytes)) ||
+        !batch_init(&batch, &program, &arena)) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    float* rows = arena_alloc(&arena, rowBytes);
+    FILE* output = NULL;
+    bool csvOutput = argc > 3 && has_extension(argv[3], ".csv");
+    if (argc > 3) {
+        output = fopen(argv[3], "wb");
+        if (!output) {
+            printf("Failed to create %s\n", argv[3]);
+            return 1;
+        }
+        if (csvOutput) write_csv_header(output, &graph, &program);
+    }
+
+    double readSeconds = 0.0, evalSeconds = 0.0, writeSeconds = 0.0;
+    long long rowCount = 0;
+    int read;
+    for (;;) {
+        double start = now_seconds();
+        read = read_rows(&reader, rows, inputCount);
+        if (read <= 0) break;
+        for (int p = 0; p < inputCount; p++) {
+            float* column = batch_input(&batch, p);
+            for (int r = 0; r < read; r++) column[r] = rows[(size_t)r * inputCount + p];
+        }
+        double evalStart = now_seconds();
+        readSeconds += evalStart - start;
+        batch_run(&batch, read);
+        double writeStart = now_seconds();
+        evalSeconds += writeStart - evalStart;
+        for (int o = 0; o < program.outputCount; o++) {
+            const float* column = batch_output(&batch, o);
+            for (int r = 0; r < read; r++) rows[(size_t)r * program.outputCount + o] = column[r];
+        }
+        if (output) write_rows(output, csvOutput, rows, read, program.outputCount);
+        writeSeconds += now_seconds() - writeStart;
+        rowCount += read;
+    }
+    fclose(reader.file);
+    free(reader.line);
+    if (output && fclose(output) != 0) {
+        printf("Failed to write %s\n", argv[3]);
+        read = -1;
+    }
+    double totalSeconds = readSeconds + evalSeconds + writeSeconds;
+    printf("rows=%lld isa=%s read_ms=%.1f eval_ms=%.1f write_ms=%.1f rows_per_sec=%.3g eval_rows_per_sec=%.3g\n",
+           rowCount, batch_isa(), readSeconds * 1e3, evalSeconds * 1e3, writeSeconds * 1e3,
+           totalSeconds > 0.0 ? rowCount / totalSeconds : 0.0, evalSeconds > 0.0 ? rowCount / evalSeconds : 0.0);
+
+    arena_destroy(&arena);
+    bytecode_destroy(&program);
+    free(inputs);
+    eval_destroy(&eval);
+    graph_destroy(&graph);
+    return read < 0 ? 1 : 0;
+}
@@ -0,0 +1,37 @@
+#include "mem.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+
+static atomic_llong allocations, reallocations, frees, bytesRequested;
+
+void* mem_alloc(size_t bytes) {
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&bytesRequested, (long long)bytes, memory_order_relaxed);
+    return malloc(bytes);
+}
+
+void* mem_calloc(size_t count, size_t size) {
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&bytesRequested, (long long)(count * size), memory_order_relaxed);
+    return calloc(count, size);
+}
+
+void* mem_realloc(void* memory, size_t bytes) {
+    atomic_fetch_add_explicit(memory ? &reallocations : &allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&bytesRequested, (long long)bytes, memory_order_relaxed);
+    return realloc(memory, bytes);
+}
+
+void mem_free(void* memory) {
+    if (memory) atomic_fetch_add_explicit(&frees, 1, memory_order_relaxed);
+    free(memory);
+}
+
+MemStats mem_stats(void) {
+    MemStats stats;
+    stats.allocations = atomic_load_explicit(&allocations, memory_order_relaxed);
+    stats.reallocations = atomic_load_explicit(&reallocations, memory_order_relaxed);
+    stats.frees = atomic_load_explicit(&frees, memory_order_relaxed);
+    stats.bytes = atomic_load_explicit(&bytesRequested, memory_order_relaxed);
+    return stats;
+}
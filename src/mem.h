@@ -0,0 +1,27 @@
+#ifndef MEM_H
+#define MEM_H
+
+#include <stddef.h>
+
+// Counted heap calls. The editor and its data structures allocate through these instead of
+// malloc and friends, so a profiler or benchmark can check how often the heap is hit, e.g.
+// that a steady frame loop never is. Safe to call from any thread. Memory from these may be
+// passed to free, and memory from malloc to mem_free; only the counts would be off.
+typedef struct {
+    long long allocations;   // mem_alloc and mem_calloc calls, and mem_realloc of NULL
+    long long reallocations; // mem_realloc of existing blocks
+    long long frees;         // mem_free of non-NULL blocks
+    long long bytes;         // requested by all of the above
+} MemStats;
+
+void* mem_alloc(size_t bytes);
+void* mem_calloc(size_t count, size_t size);
+void* mem_realloc(void* memory, size_t bytes);
+void mem_free(void* memory);
+
+// Counts so far; subtract two snapshots for an interval.
+MemStats mem_stats(void);
+// Heap calls of any kind that can allocate, the number to keep at zero in a hot loop.
+static inline long long mem_heap_calls(const MemStats* stats) { return stats->allocations + stats->reallocations; }
+
+#endif
@@ -0,0 +1,76 @@
+#include "ndc_transform.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define NDC_TRANSFORM_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NDC_TRANSFORM_SSE
+#endif
+
+NdcTransform ndc_transform_from_camera(const Camera* camera, float viewWidth, float viewHeight) {
+    NdcTransform transform;
+    transform.scaleX = 2.0f * camera->scale / viewWidth;
+    transform.offsetX = -2.0f * camera->x / viewWidth - 1.0f;
+    transform.scaleY = -2.0f * camera->scale / viewHeight;
+    transform.offsetY = 2.0f * camera->y / viewHeight + 1.0f;
+    return transform;
+}
+
+void ndc_transform_rects_scalar(const NdcTransform* transform, const float* x, const float* y,
+                                const float* width, const float* height, int count,
+                                float* left, float* top, float* right, float* bottom) {
+    const float sx = transform->scaleX, sy = transform->scaleY;
+    const float ox = transform->offsetX, oy = transform->offsetY;
+    for (int i = 0; i < count; i++) {
+        left[i] = x[i] * sx + ox;
+        right[i] = (x[i] + width[i]) * sx + ox;
+        top[i] = y[i] * sy + oy;
+        bottom[i] = (y[i] + height[i]) * sy + oy;
+    }
+}
+
+void ndc_transform_rects(const NdcTransform* transform, const float* x, const float* y,
+                         const float* width, const float* height, int count,
+                         float* left, float* top, float* right, float* bottom) {
+    int i = 0;
+#if defined(NDC_TRANSFORM_AVX)
+    const __m256 sx = _mm256_set1_ps(transform->scaleX), sy = _mm256_set1_ps(transform->scaleY);
+    const __m256 ox = _mm256_set1_ps(transform->offsetX), oy = _mm256_set1_ps(transform->offsetY);
+    for (; i + 8 <= count; i += 8) {
+        __m256 vx = _mm256_loadu_ps(x + i);
+        __m256 vy = _mm256_loadu_ps(y + i);
+        __m256 vr = _mm256_add_ps(vx, _mm256_loadu_ps(width + i));
+        __m256 vb = _mm256_add_ps(vy, _mm256_loadu_ps(height + i));
+        _mm256_storeu_ps(left + i, _mm256_add_ps(_mm256_mul_ps(vx, sx), ox));
+        _mm256_storeu_ps(right + i, _mm256_add_ps(_mm256_mul_ps(vr, sx), ox));
+        _mm256_storeu_ps(top + i, _mm256_add_ps(_mm256_mul_ps(vy, sy), oy));
+        _mm256_storeu_ps(bottom + i, _mm256_add_ps(_mm256_mul_ps(vb, sy), oy));
+    }
+#elif defined(NDC_TRANSFORM_SSE)
+    const __m128 sx = _mm_set1_ps(transform->scaleX), sy = _mm_set1_ps(transform->scaleY);
+    const __m128 ox = _mm_set1_ps(transform->offsetX), oy = _mm_set1_ps(transform->offsetY);
+    for (; i + 4 <= count; i += 4) {
+        __m128 vx = _mm_loadu_ps(x + i);
+        __m128 vy = _mm_loadu_ps(y + i);
+        __m128 vr = _mm_add_ps(vx, _mm_loadu_ps(width + i));
+        __m128 vb = _mm_add_ps(vy, _mm_loadu_ps(height + i));
+        _mm_storeu_ps(left + i, _mm_add_ps(_mm_mul_ps(vx, sx), ox));
+        _mm_storeu_ps(right + i, _mm_add_ps(_mm_mul_ps(vr, sx), ox));
+        _mm_storeu_ps(top + i, _mm_add_ps(_mm_mul_ps(vy, sy), oy));
+        _mm_storeu_ps(bottom + i, _mm_add_ps(_mm_mul_ps(vb, sy), oy));
+    }
+#endif
+    ndc_transform_rects_scalar(transform, x + i, y + i, width + i, height + i, count - i,
+                               left + i, top + i, right + i, bottom + i);
+}
+
+const char* ndc_transform_isa(void) {
+#if defined(NDC_TRANSFORM_AVX)
+    return "avx";
+#elif defined(NDC_TRANSFORM_SSE)
+    return "sse";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,28 @@
+#ifndef NDC_TRANSFORM_H
+#define NDC_TRANSFORM_H
+
+#include "camera.h"
+
+// World to normalized device coordinates as one multiply-add per axis:
+// ndc = world * scale + offset. Folds the camera and the viewport size together.
+typedef struct {
+    float scaleX, scaleY;
+    float offsetX, offsetY;
+} NdcTransform;
+
+NdcTransform ndc_transform_from_camera(const Camera* camera, float viewWidth, float viewHeight);
+
+// Transforms count world rectangles, given as separate x/y/width/height arrays, into NDC
+// edge arrays. The output arrays must not overlap the inputs. Uses AVX or SSE when the
+// compiler targets them (e.g. -mavx or /arch:AVX), and plain C otherwise.
+void ndc_transform_rects(const NdcTransform* transform, const float* x, const float* y,
+                         const float* width, const float* height, int count,
+                         float* left, float* top, float* right, float* bottom);
+// Plain C version, always available; used for tails and as a reference.
+void ndc_transform_rects_scalar(const NdcTransform* transform, const float* x, const float* y,
+                                const float* width, const float* height, int count,
+                                float* left, float* top, float* right, float* bottom);
+// Name of the code path ndc_transform_rects was compiled with: "avx", "sse" or "scalar".
+const char* ndc_transform_isa(void);
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef NODE2D_H
+#define NODE2D_H
+
+#include <math.h>
+#include "camera.h"
+
+#define WINDOW_WIDTH 800
+#define WINDOW_HEIGHT 600
+#define NODE_WIDTH 100.0f
+#define NODE_HEIGHT 100.0f
+#define HEADER_HEIGHT 24.0f
+#define SLOT_RADIUS 8.0f
+#define DISCONNECT_DISTANCE 5.0f
+#define OUTLINE_RADIUS 10.0f
+#define BORDER_OFFSET 2.0f
+#define ZOOM_MIN 0.02f
+#define ZOOM_MAX 2.0f
+#define ZOOM_STEP 0.1f // zoom changes by a factor of e^ZOOM_STEP per wheel notch
+#define GRID_SIZE 20.0f
+#define SPATIAL_CELL_SIZE 256.0f
+#define LABEL_OVERHANG 160.0f // labels may run past the right edge of a node
+#define FRAME_RATE_CAP 144 // frames per second when vsync is unavailable
+#define GRAPH_FILE_PATH "graph.n2d" // saved with Ctrl+S, opened with Ctrl+O
+#define GRAPH_JSON_PATH "graph.json" // exported with Ctrl+E, imported with Ctrl+I
+#define AUTOSAVE_PATH "autosave.n2d"
+#define AUTOSAVE_INTERVAL_MS 5000 // autosave at most this often while the graph keeps changing
+#define UNDO_HISTORY_BYTES (8u << 20) // undo journal size; the oldest edits are forgotten beyond it
+#define FRAME_SCRATCH_BYTES (2u << 20) // per-frame scratch arena; a 4K view's cluster bins take 0.5 MB
+#define VERTEX_STREAM_BYTES (1u << 20) // per-frame vertex data before the stream has to grow
+#define IDLE_WAIT_MS 500 // longest the loop sleeps waiting for input when nothing needs drawing
+#define WIRE_HANDLE_MIN 40.0f // shortest horizontal tangent of a wire, so short wires still bend
+#define WIRE_SEGMENTS_PER_ZOOM 24 // line segments per wire at zoom 1, scaled with the zoom
+#define WIRE_SEGMENTS_MIN 8
+#define WIRE_SEGMENTS_MAX 64
+#define WIRE_PICK_SEGMENTS 16 // polyline used for picking wires
+// Level-of-detail thresholds: the on-screen size, in pixels, below which a feature is dropped.
+#define LOD_LABEL_PIXELS 10.0f   // header height; the labels are drawn in the header
+#define LOD_SLOT_PIXELS 4.0f     // slot diameter
+#define LOD_HEADER_PIXELS 3.0f   // header height
+#define LOD_CLUSTER_PIXELS 8.0f  // node width; smaller nodes are drawn as cluster impostors
+
+// What is drawn at a camera scale, from full detail down to cluster impostors.
+typedef enum {
+    LOD_FULL,
+    LOD_NO_LABELS,
+    LOD_NO_SLOTS,
+    LOD_BODIES,   // body rectangles only
+    LOD_CLUSTERS  // one impostor per screen cell that contains nodes; short wires are hidden
+} LodLevel;
+
+static inline LodLevel lod_level(float scale) {
+    if (NODE_WIDTH * scale < LOD_CLUSTER_PIXELS) return LOD_CLUSTERS;
+    if (HEADER_HEIGHT * scale < LOD_HEADER_PIXELS) return LOD_BODIES;
+    if (SLOT_RADIUS * 2 * scale < LOD_SLOT_PIXELS) return LOD_NO_SLOTS;
+    if (HEADER_HEIGHT * scale < LOD_LABEL_PIXELS) return LOD_NO_LABELS;
+    return LOD_FULL;
+}
+
+#define NODE_MAX_INPUTS 3
+
+// What a node computes; the operators and value types are defined by the evaluator (eval.h).
+// Stored in files by number, so new types go at the end.
+typedef enum {
+    NODE_VARIABLE, // outputs its input when connected, otherwise its own value
+    NODE_TOGGLE,   // a boolean constant
+    NODE_ADD,
+    NODE_SUBTRACT,
+    NODE_MULTIPLY,
+    NODE_DIVIDE,
+    NODE_MIN,
+    NODE_MAX,
+    NODE_LESS,
+    NODE_GREATER,
+    NODE_EQUAL,
+    NODE_AND,
+    NODE_OR,
+    NODE_NOT,
+    NODE_SELECT,   // condition ? second input : third input
+    NODE_TYPE_COUNT
+} NodeType;
+
+static inline int node_input_count(NodeType type) {
+    switch (type) {
+    case NODE_TOGGLE: return 0;
+    case NODE_VARIABLE:
+    case NODE_NOT: return 1;
+    case NODE_SELECT: return 3;
+    default: return 2;
+    }
+}
+
+static inline const char* node_type_name(NodeType type) {
+    static const char* names[NODE_TYPE_COUNT] = {
+        "Variable", "Toggle", "Add", "Subtract", "Multiply", "Divide", "Min", "Max",
+        "Less", "Greater", "Equal", "And", "Or", "Not", "Select"};
+    return type >= 0 && type < NODE_TYPE_COUNT ? names[type] : "Unknown";
+}
+
+typedef struct {
+    float x, y;
+    float width, height;
+    char name[32];
+    NodeType type;
+    float value; // the constant of a Variable or Toggle
+    float inputX, inputY[NODE_MAX_INPUTS];
+    float outputX, outputY;
+} Node2D;
+
+typedef struct {
+    int fromNode;
+    int toNode;
+    int toSlot; // input slot of toNode, below node_input_count of its type
+} Connection;
+
+// The output sits on the right edge, centred in the body below the header; the inputs are
+// spread evenly down the left edge.
+static inline void node_update_slots(Node2D* node) {
+    int inputs = node_input_count(node->type);
+    float body = node->height - HEADER_HEIGHT;
+    node->inputX = node->x;
+    for (int i = 0; i < inputs; i++) node->inputY[i] = node->y + HEADER_HEIGHT + body * (i + 1) / (inputs + 1);
+    node->outputX = node->x + node->width;
+    node->outputY = node->y + HEADER_HEIGHT + body / 2;
+}
+
+// World-space box covering a node and the outlines drawn around its slots.
+static inline void node_bounds(const Node2D* node, float* minX, float* minY, float* maxX, float* maxY) {
+    *minX = node->x - OUTLINE_RADIUS;
+    *minY = node->y - BORDER_OFFSET;
+    *maxX = node->x + node->width + OUTLINE_RADIUS;
+    *maxY = node->y + node->height + BORDER_OFFSET;
+}
+
+// Wires are cubic Beziers leaving the output slot to the right and entering the input slot
+// from the left. The handles grow with the horizontal distance between the slots.
+static inline float wire_handle_length(float x1, float x2) {
+    return fmaxf(fabsf(x2 - x1) * 0.5f, WIRE_HANDLE_MIN);
+}
+
+static inline void wire_point(float x1, float y1, float x2, float y2, float t, float* x, float* y) {
+    float h = wire_handle_length(x1, x2);
+    float u = 1.0f - t;
+    float b0 = u * u * u;
+    float b1 = 3.0f * u * u * t;
+    float b2 = 3.0f * u * t * t;
+    float b3 = t * t * t;
+    *x = b0 * x1 + b1 * (x1 + h) + b2 * (x2 - h) + b3 * x2;
+    *y = (b0 + b1) * y1 + (b2 + b3) * y2;
+}
+
+// The curve stays inside the hull of its control points, so their box bounds it.
+static inline void wire_bounds(float x1, float y1, float x2, float y2,
+                               float* minX, float* minY, float* maxX, float* maxY) {
+    float h = wire_handle_length(x1, x2);
+    *minX = fminf(fminf(x1, x2), x2 - h);
+    *maxX = fmaxf(fmaxf(x1, x2), x1 + h);
+    *minY = fminf(y1, y2);
+    *maxY = fmaxf(y1, y2);
+}
+
+#endif
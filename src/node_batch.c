@@ -0,0 +1,248 @@
+#include "node_batch.h"
+#include "gl_util.h"
+#include "ndc_transform.h"
+#include "mem.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char* batchVertexShaderSource = "#version 330 core\n"
+    "layout (location = 0) in vec2 aCorner;\n"
+    "layout (location = 1) in float aLeft;\n"
+    "layout (location = 2) in float aTop;\n"
+    "layout (location = 3) in float aRight;\n"
+    "layout (location = 4) in float aBottom;\n"
+    "layout (location = 5) in vec4 aColorShape;\n"
+    "uniform vec2 viewport;\n"
+    "out vec2 TexCoord;\n"
+    "out vec2 PixelSize;\n"
+    "flat out vec4 ColorShape;\n"
+    "void main() {\n"
+    "   gl_Position = vec4(mix(aLeft, aRight, aCorner.x), mix(aTop, aBottom, aCorner.y), 0.0, 1.0);\n"
+    "   TexCoord = aCorner;\n"
+    "   PixelSize = vec2(aRight - aLeft, aTop - aBottom) * viewport * 0.5;\n"
+    "   ColorShape = aColorShape;\n"
+    "}\n";
+
+static const char* batchFragmentShaderSource = "#version 330 core\n"
+    "out vec4 FragColor;\n"
+    "in vec2 TexCoord;\n"
+    "in vec2 PixelSize;\n"
+    "flat in vec4 ColorShape;\n"
+    "void main() {\n"
+    "   int shape = int(ColorShape.w + 0.5);\n"
+    "   if (shape == 1) {\n"
+    "       if (length(TexCoord - vec2(0.5, 0.5)) > 0.5) discard;\n"
+    "   } else if (shape == 2) {\n"
+    "       vec2 p = TexCoord * PixelSize;\n"
+    "       if (p.x > 1.0 && p.y > 1.0 && p.x < PixelSize.x - 1.0 && p.y < PixelSize.y - 1.0) discard;\n"
+    "   }\n"
+    "   FragColor = vec4(ColorShape.rgb, 1.0);\n"
+    "}\n";
+
+#define NODE_INSTANCE_FLOATS 8 // four edges plus r, g, b, shape
+
+// The edges are uploaded as four planes of batch->total floats followed by the styles, so
+// each attribute is pointed at its own plane.
+static void set_instance_pointers(const NodeBatch* batch, int firstInstance) {
+    size_t base = (size_t)batch->instanceOffset;
+    size_t plane = (size_t)batch->total * sizeof(float);
+    size_t first = (size_t)firstInstance * sizeof(float);
+    for (int edge = 0; edge < 4; edge++) {
+        glVertexAttribPointer(1 + edge, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)(base + plane * edge + first));
+    }
+    glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(base + plane * 4 + first * 4));
+}
+
+bool node_batch_init(NodeBatch* batch) {
+    memset(batch, 0, sizeof(*batch));
+    batch->program = gl_create_program(batchVertexShaderSource, batchFragmentShaderSource);
+    if (!batch->program) return false;
+    batch->viewportLoc = glGetUniformLocation(batch->program, "viewport");
+
+    static const float corners[] = {0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f};
+    glGenVertexArrays(1, &batch->vao);
+    glGenBuffers(1, &batch->quadVBO);
+
+    glBindVertexArray(batch->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, batch->quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // The instance attributes are pointed into the vertex stream when drawing.
+    for (int attrib = 1; attrib <= 5; attrib++) {
+        glEnableVertexAttribArray(attrib);
+        glVertexAttribDivisor(attrib, 1);
+    }
+    glBindVertexArray(0);
+    return true;
+}
+
+void node_batch_destroy(NodeBatch* batch) {
+    for (int i = 0; i < NODE_LAYER_COUNT; i++) {
+        NodeLayerData* data = &batch->layers[i];
+        mem_free(data->x);
+        mem_free(data->y);
+        mem_free(data->width);
+        mem_free(data->height);
+        mem_free(data->style);
+    }
+    glDeleteBuffers(1, &batch->quadVBO);
+    glDeleteVertexArrays(1, &batch->vao);
+    glDeleteProgram(batch->program);
+    memset(batch, 0, sizeof(*batch));
+}
+
+void node_batch_begin(NodeBatch* batch) {
+    for (int i = 0; i < NODE_LAYER_COUNT; i++) batch->layers[i].count = 0;
+}
+
+static bool grow_floats(float** array, int capacity, int perItem) {
+    float* grown = mem_realloc(*array, (size_t)capacity * perItem * sizeof(float));
+    if (!grown) return false;
+    *array = grown;
+    return true;
+}
+
+void node_batch_push(NodeBatch* batch, NodeLayer layer, float x, float y, float width, float height,
+                     float r, float g, float b, NodeShape shape) {
+    NodeLayerData* data = &batch->layers[layer];
+    if (data->count == data->capacity) {
+        int newCapacity = data->capacity ? data->capacity * 2 : 256;
+        if (!grow_floats(&data->x, newCapacity, 1) || !grow_floats(&data->y, newCapacity, 1) ||
+            !grow_floats(&data->width, newCapacity, 1) || !grow_floats(&data->height, newCapacity, 1) ||
+            !grow_floats(&data->style, newCapacity, 4)) {
+            printf("Failed to grow node batch layer %d to %d instances\n", layer, newCapacity);
+            return;
+        }
+        data->capacity = newCapacity;
+    }
+    int i = data->count++;
+    data->x[i] = x;
+    data->y[i] = y;
+    data->width[i] = width;
+    data->height[i] = height;
+    float* style = &data->style[i * 4];
+    style[0] = r;
+    style[1] = g;
+    style[2] = b;
+    style[3] = (float)shape;
+}
+
+void node_batch_push_node(NodeBatch* batch, const Node2D* node, bool selected, LodLevel lod) {
+    node_batch_push(batch, NODE_LAYER_BODY, node->x, node->y, node->width, node->height,
+                    0.0f, 0.0f, 1.0f, NODE_SHAPE_RECT);
+    if (lod < LOD_BODIES) {
+        node_batch_push(batch, NODE_LAYER_HEADER, node->x, node->y, node->width, HEADER_HEIGHT,
+                        0.5f, 0.5f, 0.5f, NODE_SHAPE_RECT);
+    }
+    if (lod < LOD_NO_SLOTS) {
+        for (int s = 0; s < node_input_count(node->type); s++) {
+            node_batch_push(batch, NODE_LAYER_SLOT, node->inputX - SLOT_RADIUS, node->inputY[s] - SLOT_RADIUS,
+                            SLOT_RADIUS * 2, SLOT_RADIUS * 2, 0.0f, 1.0f, 0.0f, NODE_SHAPE_CIRCLE);
+        }
+        node_batch_push(batch, NODE_LAYER_SLOT, node->outputX - SLOT_RADIUS, node->outputY - SLOT_RADIUS,
+                        SLOT_RADIUS * 2, SLOT_RADIUS * 2, 1.0f, 0.0f, 0.0f, NODE_SHAPE_CIRCLE);
+    }
+    if (selected) {
+        node_batch_push(batch, NODE_LAYER_OVERLAY, node->x - BORDER_OFFSET, node->y - BORDER_OFFSET,
+                        node->width + BORDER_OFFSET * 2, node->height + BORDER_OFFSET * 2,
+                        1.0f, 1.0f, 0.0f, NODE_SHAPE_FRAME);
+    }
+}
+
+static int floor_div(int a, int b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+void node_batch_push_clusters(NodeBatch* batch, SpatialGrid* grid, const Camera* camera,
+                              float viewWidth, float viewHeight, Arena* scratch) {
+    int blockCells = (int)ceilf(LOD_CLUSTER_PIXELS / (grid->cellSize * camera->scale));
+    if (blockCells < 1) blockCells = 1;
+    float blockSize = blockCells * grid->cellSize;
+
+    float minX = camera->x / camera->scale, minY = camera->y / camera->scale;
+    float maxX = (camera->x + viewWidth) / camera->scale, maxY = (camera->y + viewHeight) / camera->scale;
+    int blockMinX = (int)floorf(minX / blockSize), blockMinY = (int)floorf(minY / blockSize);
+    int columns = (int)floorf(maxX / blockSize) - blockMinX + 1;
+    int rows = (int)floorf(maxY / blockSize) - blockMinY + 1;
+    int* bins = arena_alloc(scratch, (size_t)columns * rows * sizeof(int));
+    if (!bins) {
+        printf("No scratch memory for %d cluster bins\n", columns * rows);
+        return;
+    }
+    memset(bins, 0, (size_t)columns * rows * sizeof(int));
+
+    const GridCell** cells;
+    int cellCount = spatial_grid_query_cells(grid, minX, minY, maxX, maxY, &cells);
+    for (int c = 0; c < cellCount; c++) {
+        int column = floor_div(cells[c]->cellX, blockCells) - blockMinX;
+        int row = floor_div(cells[c]->cellY, blockCells) - blockMinY;
+        if (column < 0 || column >= columns || row < 0 || row >= rows) continue;
+        bins[row * columns + column] += cells[c]->count;
+    }
+
+    for (int row = 0; row < rows; row++) {
+        for (int column = 0; column < columns; column++) {
+            int count = bins[row * columns + column];
+            if (count == 0) continue;
+            // Denser blocks are lighter, saturating at a few hundred nodes.
+            float density = fminf(log2f(1.0f + count) / 8.0f, 1.0f);
+            node_batch_push(batch, NODE_LAYER_BODY, (blockMinX + column) * blockSize, (blockMinY + row) * blockSize,
+                            blockSize, blockSize, 0.6f * density, 0.6f * density, 0.4f + 0.6f * density,
+                            NODE_SHAPE_RECT);
+        }
+    }
+}
+
+void node_batch_upload(NodeBatch* batch, StreamBuffer* stream, const Camera* camera, float viewWidth, float viewHeight) {
+    int total = 0;
+    for (int i = 0; i < NODE_LAYER_COUNT; i++) {
+        batch->offsets[i] = total;
+        total += batch->layers[i].count;
+    }
+    batch->total = total;
+    batch->viewWidth = viewWidth;
+    batch->viewHeight = viewHeight;
+    if (total == 0) return;
+
+    float* left = stream_buffer_map(stream, (size_t)total * NODE_INSTANCE_FLOATS * sizeof(float), &batch->instanceOffset);
+    if (!left) {
+        batch->total = 0;
+        return;
+    }
+    batch->instanceBuffer = stream->buffer;
+
+    // One streaming pass per layer writes the NDC edges straight into the mapped planes.
+    NdcTransform transform = ndc_transform_from_camera(camera, viewWidth, viewHeight);
+    float* top = left + total;
+    float* right = top + total;
+    float* bottom = right + total;
+    float* style = bottom + total;
+    for (int i = 0; i < NODE_LAYER_COUNT; i++) {
+        const NodeLayerData* data = &batch->layers[i];
+        if (data->count == 0) continue;
+        int o = batch->offsets[i];
+        ndc_transform_rects(&transform, data->x, data->y, data->width, data->height, data->count,
+                            left + o, top + o, right + o, bottom + o);
+        memcpy(style + o * 4, data->style, (size_t)data->count * 4 * sizeof(float));
+    }
+    stream_buffer_unmap(stream);
+}
+
+void node_batch_draw(NodeBatch* batch, NodeLayer first, NodeLayer last) {
+    if (batch->total == 0) return;
+    glUseProgram(batch->program);
+    glUniform2f(batch->viewportLoc, batch->viewWidth, batch->viewHeight);
+    glBindVertexArray(batch->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, batch->instanceBuffer);
+    for (int i = (int)first; i <= (int)last; i++) {
+        if (batch->layers[i].count == 0) continue;
+        // GL 3.3 has no base instance, so re-point the instance attributes at the layer instead.
+        set_instance_pointers(batch, batch->offsets[i]);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, batch->layers[i].count);
+        renderStats.drawCalls++;
+    }
+    glBindVertexArray(0);
+}
@@ -0,0 +1,75 @@
+#ifndef NODE_BATCH_H
+#define NODE_BATCH_H
+
+#include <glad/gl.h>
+#include <stdbool.h>
+#include "node2d.h"
+#include "spatial_grid.h"
+#include "arena.h"
+#include "stream_buffer.h"
+
+// Draw order of the instanced node quads. Each layer is drawn with one instanced call.
+typedef enum {
+    NODE_LAYER_BODY,
+    NODE_LAYER_HEADER,
+    NODE_LAYER_SLOT,
+    NODE_LAYER_OVERLAY, // selection border and connection outlines, drawn above the labels
+    NODE_LAYER_COUNT
+} NodeLayer;
+
+typedef enum {
+    NODE_SHAPE_RECT,
+    NODE_SHAPE_CIRCLE,
+    NODE_SHAPE_FRAME
+} NodeShape;
+
+// Quads of one layer in world space. Rectangles are kept as separate float arrays so the
+// NDC transform can stream through them; style holds r, g, b and shape per quad.
+typedef struct {
+    float* x;
+    float* y;
+    float* width;
+    float* height;
+    float* style;
+    int count;
+    int capacity;
+} NodeLayerData;
+
+typedef struct {
+    GLuint program;
+    GLuint vao;
+    GLuint quadVBO;
+    GLint viewportLoc;
+    NodeLayerData layers[NODE_LAYER_COUNT];
+    int offsets[NODE_LAYER_COUNT]; // first instance of each layer in the uploaded range
+    int total;                     // instances uploaded, also the stride between edge planes
+    // This frame's instances in the vertex stream: left, top, right and bottom planes of
+    // total floats each, then style.
+    GLuint instanceBuffer;
+    GLintptr instanceOffset;
+    float viewWidth, viewHeight;
+} NodeBatch;
+
+bool node_batch_init(NodeBatch* batch);
+void node_batch_destroy(NodeBatch* batch);
+
+// Clears the CPU side instance lists for a new frame.
+void node_batch_begin(NodeBatch* batch);
+void node_batch_push(NodeBatch* batch, NodeLayer layer, float x, float y, float width, float height,
+                     float r, float g, float b, NodeShape shape);
+// Pushes the parts of a node the level of detail keeps: body, header, both slots and, if
+// selected, the selection border.
+void node_batch_push_node(NodeBatch* batch, const Node2D* node, bool selected, LodLevel lod);
+// Pushes one body-layer impostor per block of grid cells that holds nodes, shaded by how many
+// it holds. Blocks are whole grid cells at least LOD_CLUSTER_PIXELS on screen, aligned in
+// world space so they do not shimmer while panning. Costs one visit per occupied cell in view,
+// however many nodes the cells hold. The per-block counts are scratch taken from the arena.
+void node_batch_push_clusters(NodeBatch* batch, SpatialGrid* grid, const Camera* camera,
+                              float viewWidth, float viewHeight, Arena* scratch);
+// Transforms every layer to NDC for the given camera, writing straight into the vertex
+// stream. The instances can be drawn until the stream's frame ends.
+void node_batch_upload(NodeBatch* batch, StreamBuffer* stream, const Camera* camera, float viewWidth, float viewHeight);
+// Draws layers first..last (inclusive), one instanced call per non-empty layer.
+void node_batch_draw(NodeBatch* batch, NodeLayer first, NodeLayer last);
+
+#endif
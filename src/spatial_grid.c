@@ -0,0 +1,298 @@
+#include "spatial_grid.h"
+#include "mem.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t hash_cell(int cellX, int cellY) {
+    uint32_t h = (uint32_t)cellX * 0x9E3779B1u ^ (uint32_t)cellY * 0x85EBCA77u;
+    return h ^ (h >> 15);
+}
+
+static GridCell* find_cell(const SpatialGrid* grid, int cellX, int cellY) {
+    uint32_t mask = (uint32_t)grid->cellCapacity - 1;
+    for (uint32_t i = hash_cell(cellX, cellY) & mask;; i = (i + 1) & mask) {
+        GridCell* cell = &grid->cells[i];
+        if (!cell->used) return NULL;
+        if (cell->cellX == cellX && cell->cellY == cellY) return cell;
+    }
+}
+
+static bool grow_cells(SpatialGrid* grid) {
+    int newCapacity = grid->cellCapacity * 2;
+    GridCell* cells = mem_calloc(newCapacity, sizeof(GridCell));
+    if (!cells) return false;
+    uint32_t mask = (uint32_t)newCapacity - 1;
+    for (int c = 0; c < grid->cellCapacity; c++) {
+        if (!grid->cells[c].used) continue;
+        uint32_t i = hash_cell(grid->cells[c].cellX, grid->cells[c].cellY) & mask;
+        while (cells[i].used) i = (i + 1) & mask;
+        cells[i] = grid->cells[c];
+    }
+    mem_free(grid->cells);
+    grid->cells = cells;
+    grid->cellCapacity = newCapacity;
+    return true;
+}
+
+static GridCell* get_or_add_cell(SpatialGrid* grid, int cellX, int cellY) {
+    GridCell* cell = find_cell(grid, cellX, cellY);
+    if (cell) return cell;
+    if ((grid->cellsUsed + 1) * 2 > grid->cellCapacity && !grow_cells(grid)) return NULL;
+    uint32_t mask = (uint32_t)grid->cellCapacity - 1;
+    uint32_t i = hash_cell(cellX, cellY) & mask;
+    while (grid->cells[i].used) i = (i + 1) & mask;
+    cell = &grid->cells[i];
+    cell->cellX = cellX;
+    cell->cellY = cellY;
+    cell->used = true;
+    grid->cellsUsed++;
+    grid->cellsEmpty++; // until the caller adds to it
+    return cell;
+}
+
+// Rebuilds the table without its empty cells, which otherwise pile up behind dragged nodes
+// and slow the occupied-cell walk of large queries. Amortized over the removals that
+// emptied them, since it only runs once they outnumber half the occupied cells.
+static void drop_empty_cells(SpatialGrid* grid) {
+    if (grid->cellsEmpty * 2 <= grid->cellsUsed || grid->cellCapacity <= 256) return;
+    int live = grid->cellsUsed - grid->cellsEmpty;
+    int newCapacity = 256;
+    while (live * 4 > newCapacity) newCapacity *= 2;
+    GridCell* cells = mem_calloc(newCapacity, sizeof(GridCell));
+    if (!cells) return; // the old table still works
+    uint32_t mask = (uint32_t)newCapacity - 1;
+    for (int c = 0; c < grid->cellCapacity; c++) {
+        GridCell* cell = &grid->cells[c];
+        if (!cell->used) continue;
+        if (cell->count == 0) {
+            mem_free(cell->items);
+            continue;
+        }
+        uint32_t i = hash_cell(cell->cellX, cell->cellY) & mask;
+        while (cells[i].used) i = (i + 1) & mask;
+        cells[i] = *cell;
+    }
+    mem_free(grid->cells);
+    grid->cells = cells;
+    grid->cellCapacity = newCapacity;
+    grid->cellsUsed = live;
+    grid->cellsEmpty = 0;
+}
+
+static bool reserve_items(SpatialGrid* grid, int id) {
+    if (id < grid->itemCapacity) return true;
+    int newCapacity = grid->itemCapacity ? grid->itemCapacity : 1024;
+    while (newCapacity <= id) newCapacity *= 2;
+    GridItem* items = mem_realloc(grid->items, newCapacity * sizeof(GridItem));
+    if (!items) return false;
+    memset(items + grid->itemCapacity, 0, (newCapacity - grid->itemCapacity) * sizeof(GridItem));
+    grid->items = items;
+    unsigned* stamps = mem_realloc(grid->stamps, newCapacity * sizeof(unsigned));
+    if (!stamps) return false;
+    memset(stamps + grid->itemCapacity, 0, (newCapacity - grid->itemCapacity) * sizeof(unsigned));
+    grid->stamps = stamps;
+    int* results = mem_realloc(grid->results, newCapacity * sizeof(int));
+    if (!results) return false;
+    grid->results = results;
+    grid->resultCapacity = newCapacity;
+    grid->itemCapacity = newCapacity;
+    return true;
+}
+
+static void add_to_cells(SpatialGrid* grid, int id, const GridItem* item) {
+    for (int cy = item->cellMinY; cy <= item->cellMaxY; cy++) {
+        for (int cx = item->cellMinX; cx <= item->cellMaxX; cx++) {
+            GridCell* cell = get_or_add_cell(grid, cx, cy);
+            if (!cell) {
+                printf("Failed to grow spatial grid\n");
+                return;
+            }
+            if (cell->count == cell->capacity) {
+                int newCapacity = cell->capacity ? cell->capacity * 2 : 8;
+                int* cellItems = mem_realloc(cell->items, newCapacity * sizeof(int));
+                if (!cellItems) {
+                    printf("Failed to grow spatial grid cell\n");
+                    return;
+                }
+                cell->items = cellItems;
+                cell->capacity = newCapacity;
+            }
+            if (cell->count == 0) grid->cellsEmpty--;
+            cell->items[cell->count++] = id;
+        }
+    }
+}
+
+static void remove_from_cells(SpatialGrid* grid, int id, const GridItem* item) {
+    for (int cy = item->cellMinY; cy <= item->cellMaxY; cy++) {
+        for (int cx = item->cellMinX; cx <= item->cellMaxX; cx++) {
+            GridCell* cell = find_cell(grid, cx, cy);
+            if (!cell) continue;
+            for (int i = 0; i < cell->count; i++) {
+                if (cell->items[i] == id) {
+                    cell->items[i] = cell->items[--cell->count];
+                    if (cell->count == 0) grid->cellsEmpty++;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+static void set_bounds(const SpatialGrid* grid, GridItem* item, float minX, float minY, float maxX, float maxY) {
+    item->minX = minX;
+    item->minY = minY;
+    item->maxX = maxX;
+    item->maxY = maxY;
+    item->cellMinX = (int)floorf(minX / grid->cellSize);
+    item->cellMinY = (int)floorf(minY / grid->cellSize);
+    item->cellMaxX = (int)floorf(maxX / grid->cellSize);
+    item->cellMaxY = (int)floorf(maxY / grid->cellSize);
+}
+
+bool spatial_grid_init(SpatialGrid* grid, float cellSize) {
+    memset(grid, 0, sizeof(*grid));
+    grid->cellSize = cellSize;
+    grid->cellCapacity = 256;
+    grid->cells = mem_calloc(grid->cellCapacity, sizeof(GridCell));
+    return grid->cells != NULL;
+}
+
+void spatial_grid_destroy(SpatialGrid* grid) {
+    for (int i = 0; i < grid->cellCapacity; i++) mem_free(grid->cells[i].items);
+    mem_free(grid->cells);
+    mem_free(grid->items);
+    mem_free(grid->stamps);
+    mem_free(grid->results);
+    mem_free(grid->cellResults);
+    memset(grid, 0, sizeof(*grid));
+}
+
+void spatial_grid_insert(SpatialGrid* grid, int id, float minX, float minY, float maxX, float maxY) {
+    if (!reserve_items(grid, id)) {
+        printf("Failed to grow spatial grid to %d items\n", id + 1);
+        return;
+    }
+    GridItem* item = &grid->items[id];
+    if (item->present) remove_from_cells(grid, id, item);
+    set_bounds(grid, item, minX, minY, maxX, maxY);
+    item->present = true;
+    add_to_cells(grid, id, item);
+}
+
+void spatial_grid_remove(SpatialGrid* grid, int id) {
+    if (id >= grid->itemCapacity || !grid->items[id].present) return;
+    remove_from_cells(grid, id, &grid->items[id]);
+    grid->items[id].present = false;
+    drop_empty_cells(grid);
+}
+
+void spatial_grid_update(SpatialGrid* grid, int id, float minX, float minY, float maxX, float maxY) {
+    if (id >= grid->itemCapacity || !grid->items[id].present) {
+        spatial_grid_insert(grid, id, minX, minY, maxX, maxY);
+        return;
+    }
+    GridItem* item = &grid->items[id];
+    GridItem moved = *item;
+    set_bounds(grid, &moved, minX, minY, maxX, maxY);
+    if (moved.cellMinX != item->cellMinX || moved.cellMinY != item->cellMinY ||
+        moved.cellMaxX != item->cellMaxX || moved.cellMaxY != item->cellMaxY) {
+        remove_from_cells(grid, id, item);
+        add_to_cells(grid, id, &moved);
+        drop_empty_cells(grid);
+    }
+    *item = moved;
+}
+
+static int compare_ids(const void* a, const void* b) {
+    return *(const int*)a - *(const int*)b;
+}
+
+static int collect_cell(SpatialGrid* grid, const GridCell* cell, float minX, float minY, float maxX, float maxY, int count) {
+    for (int i = 0; i < cell->count; i++) {
+        int id = cell->items[i];
+        if (grid->stamps[id] == grid->stamp) continue;
+        grid->stamps[id] = grid->stamp;
+        const GridItem* item = &grid->items[id];
+        if (item->maxX < minX || item->minX > maxX || item->maxY < minY || item->minY > maxY) continue;
+        grid->results[count++] = id;
+    }
+    return count;
+}
+
+int spatial_grid_query(SpatialGrid* grid, float minX, float minY, float maxX, float maxY, const int** ids) {
+    *ids = grid->results;
+    if (grid->itemCapacity == 0) return 0;
+
+    int cellMinX = (int)floorf(minX / grid->cellSize);
+    int cellMinY = (int)floorf(minY / grid->cellSize);
+    int cellMaxX = (int)floorf(maxX / grid->cellSize);
+    int cellMaxY = (int)floorf(maxY / grid->cellSize);
+
+    if (++grid->stamp == 0) {
+        memset(grid->stamps, 0, grid->itemCapacity * sizeof(unsigned));
+        grid->stamp = 1;
+    }
+
+    int count = 0;
+    double rectCells = ((double)cellMaxX - cellMinX + 1) * ((double)cellMaxY - cellMinY + 1);
+    if (rectCells > grid->cellsUsed) {
+        // Rectangle covers more cells than are occupied: walk the occupied ones instead.
+        for (int c = 0; c < grid->cellCapacity; c++) {
+            const GridCell* cell = &grid->cells[c];
+            if (!cell->used || cell->cellX < cellMinX || cell->cellX > cellMaxX ||
+                cell->cellY < cellMinY || cell->cellY > cellMaxY) continue;
+            count = collect_cell(grid, cell, minX, minY, maxX, maxY, count);
+        }
+    } else {
+        for (int cy = cellMinY; cy <= cellMaxY; cy++) {
+            for (int cx = cellMinX; cx <= cellMaxX; cx++) {
+                const GridCell* cell = find_cell(grid, cx, cy);
+                if (cell) count = collect_cell(grid, cell, minX, minY, maxX, maxY, count);
+            }
+        }
+    }
+    qsort(grid->results, count, sizeof(int), compare_ids);
+    return count;
+}
+
+int spatial_grid_query_cells(SpatialGrid* grid, float minX, float minY, float maxX, float maxY, const GridCell*** cells) {
+    if (grid->cellResultCapacity < grid->cellsUsed) {
+        const GridCell** grown = mem_realloc(grid->cellResults, grid->cellCapacity * sizeof(GridCell*));
+        if (!grown) {
+            printf("Failed to grow spatial grid cell results\n");
+            *cells = grid->cellResults;
+            return 0;
+        }
+        grid->cellResults = grown;
+        grid->cellResultCapacity = grid->cellCapacity;
+    }
+    *cells = grid->cellResults;
+
+    int cellMinX = (int)floorf(minX / grid->cellSize);
+    int cellMinY = (int)floorf(minY / grid->cellSize);
+    int cellMaxX = (int)floorf(maxX / grid->cellSize);
+    int cellMaxY = (int)floorf(maxY / grid->cellSize);
+
+    int count = 0;
+    double rectCells = ((double)cellMaxX - cellMinX + 1) * ((double)cellMaxY - cellMinY + 1);
+    if (rectCells > grid->cellsUsed) {
+        for (int c = 0; c < grid->cellCapacity; c++) {
+            const GridCell* cell = &grid->cells[c];
+            if (!cell->used || cell->count == 0 || cell->cellX < cellMinX || cell->cellX > cellMaxX ||
+                cell->cellY < cellMinY || cell->cellY > cellMaxY) continue;
+            grid->cellResults[count++] = cell;
+        }
+    } else {
+        for (int cy = cellMinY; cy <= cellMaxY; cy++) {
+            for (int cx = cellMinX; cx <= cellMaxX; cx++) {
+                const GridCell* cell = find_cell(grid, cx, cy);
+                if (cell && cell->count > 0) grid->cellResults[count++] = cell;
+            }
+        }
+    }
+    return count;
+}
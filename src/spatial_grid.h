@@ -0,0 +1,51 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <stdbool.h>
+
+// Uniform grid over world space, stored as a hash table of occupied cells so the world
+// can be unbounded. Items are integer ids with an axis-aligned bounding box; an item is
+// listed in every cell its box touches.
+typedef struct {
+    int cellX, cellY;
+    int* items;
+    int count, capacity;
+    bool used;
+} GridCell;
+
+typedef struct {
+    float minX, minY, maxX, maxY;
+    int cellMinX, cellMinY, cellMaxX, cellMaxY;
+    bool present;
+} GridItem;
+
+typedef struct {
+    float cellSize;
+    GridCell* cells;
+    int cellCapacity; // power of two
+    int cellsUsed;
+    int cellsEmpty;   // of cellsUsed, those whose items have all left; dropped once they dominate
+    GridItem* items; // indexed by id
+    int itemCapacity;
+    unsigned* stamps; // per id, de-duplicates items that span several cells in one query
+    unsigned stamp;
+    int* results;
+    int resultCapacity;
+    const GridCell** cellResults;
+    int cellResultCapacity;
+} SpatialGrid;
+
+bool spatial_grid_init(SpatialGrid* grid, float cellSize);
+void spatial_grid_destroy(SpatialGrid* grid);
+void spatial_grid_insert(SpatialGrid* grid, int id, float minX, float minY, float maxX, float maxY);
+void spatial_grid_remove(SpatialGrid* grid, int id);
+// Moves an item; cell lists are only touched when the set of covered cells changes.
+void spatial_grid_update(SpatialGrid* grid, int id, float minX, float minY, float maxX, float maxY);
+// Returns the ids whose boxes overlap the rectangle, in ascending order. The array is owned
+// by the grid and valid until the next query.
+int spatial_grid_query(SpatialGrid* grid, float minX, float minY, float maxX, float maxY, const int** ids);
+// Returns the non-empty cells overlapping the rectangle, without visiting their items. The
+// array is owned by the grid and valid until the next call or the next change to the grid.
+int spatial_grid_query_cells(SpatialGrid* grid, float minX, float minY, float maxX, float maxY, const GridCell*** cells);
+
+#endif
@@ -0,0 +1,190 @@
+#include "stream_buffer.h"
+#include "gl_util.h"
+#include "mem.h"
+#include <SDL3/SDL.h>
+#include <stdio.h>
+#include <string.h>
+
+// glBufferStorage is GL 4.4; the loader is generated for 3.3, so it is looked up by hand.
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+typedef void (GLAD_API_PTR* BufferStorageFunction)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+#define STREAM_WAIT_NANOSECONDS 1000000000ull
+
+static BufferStorageFunction bufferStorage;
+
+static BufferStorageFunction find_buffer_storage(void) {
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    if (major * 10 + minor < 44 && !SDL_GL_ExtensionSupported("GL_ARB_buffer_storage")) return NULL;
+    return (BufferStorageFunction)SDL_GL_GetProcAddress("glBufferStorage");
+}
+
+// A new buffer of STREAM_FRAMES regions, or of one when it is orphaned every frame anyway.
+static void create_buffer(StreamBuffer* stream, size_t regionBytes) {
+    GLsizeiptr bytes = (GLsizeiptr)(regionBytes * (stream->mode == STREAM_ORPHAN ? 1 : STREAM_FRAMES));
+    glGenBuffers(1, &stream->buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, stream->buffer);
+    stream->regionBytes = regionBytes;
+    stream->region = 0;
+    stream->used = 0;
+    stream->frameStarted = true; // nothing has drawn from the new buffer yet
+    if (stream->mode != STREAM_PERSISTENT) {
+        glBufferData(GL_ARRAY_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+        return;
+    }
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    bufferStorage(GL_ARRAY_BUFFER, bytes, NULL, flags);
+    stream->mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, flags);
+    if (!stream->mapped) {
+        printf("Persistent mapping of %zu KB failed, mapping each write instead\n", (size_t)bytes / 1024);
+        glDeleteBuffers(1, &stream->buffer);
+        stream->mode = STREAM_UNSYNCHRONIZED;
+        create_buffer(stream, regionBytes);
+    }
+}
+
+static void delete_fences(StreamBuffer* stream) {
+    for (int i = 0; i < STREAM_FRAMES; i++) {
+        if (stream->fences[i]) glDeleteSync(stream->fences[i]);
+        stream->fences[i] = NULL;
+    }
+}
+
+bool stream_buffer_init(StreamBuffer* stream, size_t regionBytes, StreamMode fastest) {
+    memset(stream, 0, sizeof(*stream));
+    stream->mode = fastest;
+    if (stream->mode == STREAM_PERSISTENT) {
+        bufferStorage = find_buffer_storage();
+        if (!bufferStorage) stream->mode = STREAM_UNSYNCHRONIZED;
+    }
+    create_buffer(stream, regionBytes > 0 ? regionBytes : STREAM_ALIGNMENT);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return stream->buffer != 0;
+}
+
+void stream_buffer_destroy(StreamBuffer* stream) {
+    delete_fences(stream);
+    if (stream->retiredCount > 0) glDeleteBuffers(stream->retiredCount, stream->retired);
+    glDeleteBuffers(1, &stream->buffer); // also unmaps a persistent mapping
+    mem_free(stream->staging);
+    memset(stream, 0, sizeof(*stream));
+}
+
+// Moves to a buffer whose regions hold at least bytes. Draws already issued this frame may
+// still read the old one, so it is only deleted once the frame is over.
+static bool grow(StreamBuffer* stream, size_t bytes) {
+    if (stream->retiredCount == STREAM_MAX_RETIRED) {
+        printf("Vertex stream grew %d times in one frame, dropping %zu bytes\n", STREAM_MAX_RETIRED, bytes);
+        return false;
+    }
+    size_t regionBytes = stream->regionBytes * 2;
+    while (regionBytes < bytes) regionBytes *= 2;
+    stream->retired[stream->retiredCount++] = stream->buffer;
+    stream->mapped = NULL;
+    delete_fences(stream); // they guard regions of the old buffer
+    create_buffer(stream, regionBytes);
+    return true;
+}
+
+// Before the first write of a frame: wait until the GPU is done with the region, or orphan.
+static void start_frame(StreamBuffer* stream) {
+    stream->frameStarted = true;
+    if (stream->mode == STREAM_ORPHAN) {
+        glBindBuffer(GL_ARRAY_BUFFER, stream->buffer);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)stream->regionBytes, NULL, GL_STREAM_DRAW);
+        return;
+    }
+    GLsync fence = stream->fences[stream->region];
+    if (!fence) return;
+    // STREAM_FRAMES - 1 frames later this has almost always passed; waiting means the GPU
+    // is that far behind.
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        renderStats.fenceWaits++;
+        do {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, STREAM_WAIT_NANOSECONDS);
+        } while (status == GL_TIMEOUT_EXPIRED);
+    }
+    glDeleteSync(fence);
+    stream->fences[stream->region] = NULL;
+}
+
+void* stream_buffer_map(StreamBuffer* stream, size_t bytes, GLintptr* offset) {
+    size_t start = (stream->used + STREAM_ALIGNMENT - 1) / STREAM_ALIGNMENT * STREAM_ALIGNMENT;
+    if (start + bytes > stream->regionBytes) {
+        if (!grow(stream, bytes)) return NULL;
+        start = 0;
+    }
+    if (!stream->frameStarted) start_frame(stream);
+    stream->used = start + bytes;
+    if (stream->used > stream->peak) stream->peak = stream->used;
+    stream->openOffset = (GLintptr)(stream->region * stream->regionBytes + start);
+    stream->openBytes = bytes;
+    renderStats.uploadBytes += (long long)bytes;
+
+    if (stream->mode == STREAM_PERSISTENT) {
+        stream->openPointer = stream->mapped + stream->openOffset;
+    } else if (stream->mode == STREAM_UNSYNCHRONIZED) {
+        glBindBuffer(GL_ARRAY_BUFFER, stream->buffer);
+        stream->openPointer = glMapBufferRange(GL_ARRAY_BUFFER, stream->openOffset, (GLsizeiptr)bytes,
+                                               GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (!stream->openPointer) {
+            // Draws later this frame may read earlier ranges, so orphaning starts next frame.
+            printf("Mapping the vertex stream failed, orphaning it instead\n");
+            stream->mode = STREAM_ORPHAN;
+        }
+    } else {
+        stream->openPointer = NULL;
+    }
+    if (!stream->openPointer) {
+        if (bytes > stream->stagingCapacity) {
+            unsigned char* grown = mem_realloc(stream->staging, bytes);
+            if (!grown) {
+                printf("Failed to grow vertex stream staging to %zu bytes\n", bytes);
+                return NULL;
+            }
+            stream->staging = grown;
+            stream->stagingCapacity = bytes;
+        }
+        stream->openPointer = stream->staging;
+    }
+    *offset = stream->openOffset;
+    return stream->openPointer;
+}
+
+void stream_buffer_unmap(StreamBuffer* stream) {
+    if (!stream->openPointer) return;
+    if (stream->openPointer == stream->staging) {
+        glBindBuffer(GL_ARRAY_BUFFER, stream->buffer);
+        glBufferSubData(GL_ARRAY_BUFFER, stream->openOffset, (GLsizeiptr)stream->openBytes, stream->staging);
+    } else if (stream->mode != STREAM_PERSISTENT) {
+        glBindBuffer(GL_ARRAY_BUFFER, stream->buffer);
+        if (!glUnmapBuffer(GL_ARRAY_BUFFER)) printf("Vertex stream contents lost; one frame may draw garbage\n");
+    }
+    stream->openPointer = NULL;
+}
+
+void stream_buffer_end_frame(StreamBuffer* stream) {
+    if (stream->mode == STREAM_ORPHAN) {
+        stream->region = 0; // also after falling back from mapping in the middle of the ring
+    } else if (stream->used > 0) {
+        stream->fences[stream->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        stream->region = (stream->region + 1) % STREAM_FRAMES;
+    }
+    stream->used = 0;
+    stream->frameStarted = false;
+    if (stream->retiredCount > 0) {
+        glDeleteBuffers(stream->retiredCount, stream->retired);
+        stream->retiredCount = 0;
+    }
+}
+
+const char* stream_buffer_mode_name(StreamMode mode) {
+    static const char* names[STREAM_MODE_COUNT] = {"persistent", "unsynchronized", "orphan"};
+    return (unsigned)mode < STREAM_MODE_COUNT ? names[mode] : "unknown";
+}
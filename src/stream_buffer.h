@@ -0,0 +1,58 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <glad/gl.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define STREAM_FRAMES 3        // frames the GPU may still be drawing from; one ring region each
+#define STREAM_ALIGNMENT 64    // start of every range handed out
+#define STREAM_MAX_RETIRED 8   // outgrown buffers awaiting deletion within one frame
+
+// How writes reach the buffer, fastest first. Init picks the fastest the context supports.
+typedef enum {
+    STREAM_PERSISTENT,     // GL 4.4 or ARB_buffer_storage: mapped once, written in place
+    STREAM_UNSYNCHRONIZED, // GL 3.3: each range mapped unsynchronized, the fences keep it safe
+    STREAM_ORPHAN,         // the buffer is orphaned every frame and filled with glBufferSubData
+    STREAM_MODE_COUNT
+} StreamMode;
+
+// Vertex data that lives for one frame, written into a single GL buffer split into
+// STREAM_FRAMES regions. Frame n writes region n % STREAM_FRAMES; a fence placed after the
+// frame is waited on before the region is written again, by which time the GPU has long
+// finished with it, so the driver never has to stall or copy behind our back. A frame that
+// needs more than a region moves to a larger buffer.
+typedef struct {
+    GLuint buffer;
+    StreamMode mode;
+    size_t regionBytes;
+    size_t used;       // of the current region this frame
+    size_t peak;       // most used in one frame
+    int region;
+    bool frameStarted; // the current region has been waited for (or orphaned)
+    GLsync fences[STREAM_FRAMES];
+    unsigned char* mapped;  // the whole buffer, in STREAM_PERSISTENT mode
+    unsigned char* staging; // CPU copy of the open range when it cannot be mapped
+    size_t stagingCapacity;
+    void* openPointer;      // range handed out by the last map, until unmapped
+    GLintptr openOffset;
+    size_t openBytes;
+    GLuint retired[STREAM_MAX_RETIRED]; // outgrown buffers still drawn from this frame
+    int retiredCount;
+} StreamBuffer;
+
+// Needs a current GL 3.3 context. Uses no mode faster than fastest, so the slower paths can
+// be measured on hardware that has the faster ones.
+bool stream_buffer_init(StreamBuffer* stream, size_t regionBytes, StreamMode fastest);
+void stream_buffer_destroy(StreamBuffer* stream);
+// Hands out bytes of this frame's region and sets *offset to where they start in
+// stream->buffer, for glVertexAttribPointer. The memory may be uncached: write it
+// sequentially and never read it back. Returns NULL if no buffer could hold the range.
+void* stream_buffer_map(StreamBuffer* stream, size_t bytes, GLintptr* offset);
+// Closes the range from the last map; call it before drawing from the range.
+void stream_buffer_unmap(StreamBuffer* stream);
+// After the frame's last draw: fences the region and moves on to the next one.
+void stream_buffer_end_frame(StreamBuffer* stream);
+const char* stream_buffer_mode_name(StreamMode mode);
+
+#endif
@@ -0,0 +1,126 @@
+#include "task_pool.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TASK_NONE -1
+#define TASK_CONTENDED -2 // lost a race for the task; the deque may still hold others
+
+// The owner's end. Taking the last task races the thieves for it through top.
+static int deque_pop(TaskDeque* deque) {
+    int b = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int t = atomic_load_explicit(&deque->top, memory_order_relaxed);
+    if (t > b) {
+        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+        return TASK_NONE;
+    }
+    int task = deque->first + b;
+    if (t == b) {
+        if (!atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1, memory_order_seq_cst,
+                                                     memory_order_relaxed)) {
+            task = TASK_NONE;
+        }
+        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+static int deque_steal(TaskDeque* deque) {
+    int t = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int b = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (t >= b) return TASK_NONE;
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+        return TASK_CONTENDED;
+    }
+    return deque->first + t;
+}
+
+// Runs the worker's own tasks, then steals until every deque is empty. Tasks taken by other
+// workers may still be running when this returns.
+static void work(TaskPool* pool, int self) {
+    int task;
+    while ((task = deque_pop(&pool->deques[self])) != TASK_NONE) pool->function(pool->data, task, self);
+    for (;;) {
+        bool retry = false;
+        for (int k = 1; k < pool->threadCount; k++) {
+            task = deque_steal(&pool->deques[(self + k) % pool->threadCount]);
+            if (task == TASK_CONTENDED) retry = true;
+            if (task < 0) continue;
+            atomic_fetch_add_explicit(&pool->steals, 1, memory_order_relaxed);
+            pool->function(pool->data, task, self);
+            retry = true; // the victim likely has more; scan again from the next worker
+            break;
+        }
+        if (!retry) return;
+    }
+}
+
+static int worker_main(void* data) {
+    TaskWorker* worker = data;
+    TaskPool* pool = worker->pool;
+    for (;;) {
+        SDL_WaitSemaphore(worker->wake);
+        if (pool->quit) break;
+        work(pool, worker->index);
+        SDL_SignalSemaphore(pool->done);
+    }
+    return 0;
+}
+
+void task_pool_init(TaskPool* pool, int threadCount) {
+    memset(pool, 0, sizeof(*pool));
+    if (threadCount <= 0) threadCount = SDL_GetNumLogicalCPUCores();
+    if (threadCount > TASK_POOL_MAX_THREADS) threadCount = TASK_POOL_MAX_THREADS;
+    pool->threadCount = 1;
+    if (threadCount > 1) pool->done = SDL_CreateSemaphore(0);
+    if (!pool->done) return;
+    for (int w = 1; w < threadCount; w++) {
+        TaskWorker* worker = &pool->workers[w];
+        worker->pool = pool;
+        worker->index = w;
+        worker->wake = SDL_CreateSemaphore(0);
+        if (worker->wake) worker->thread = SDL_CreateThread(worker_main, "eval worker", worker);
+        if (!worker->thread) {
+            printf("Failed to start worker thread %d: %s\n", w, SDL_GetError());
+            if (worker->wake) SDL_DestroySemaphore(worker->wake);
+            worker->wake = NULL;
+            break;
+        }
+        pool->threadCount++;
+    }
+}
+
+void task_pool_destroy(TaskPool* pool) {
+    pool->quit = true;
+    for (int w = 1; w < pool->threadCount; w++) {
+        SDL_SignalSemaphore(pool->workers[w].wake);
+        SDL_WaitThread(pool->workers[w].thread, NULL);
+        SDL_DestroySemaphore(pool->workers[w].wake);
+    }
+    if (pool->done) SDL_DestroySemaphore(pool->done);
+    memset(pool, 0, sizeof(*pool));
+}
+
+void task_pool_run(TaskPool* pool, int taskCount, TaskFunction function, void* data) {
+    if (taskCount <= 0) return;
+    if (pool->threadCount == 1 || taskCount == 1) {
+        for (int t = 0; t < taskCount; t++) function(data, t, 0);
+        return;
+    }
+    // The workers are asleep, so the deques can be refilled without atomics ordering
+    // anything; the semaphore publishes them.
+    for (int w = 0; w < pool->threadCount; w++) {
+        TaskDeque* deque = &pool->deques[w];
+        deque->first = (int)((long long)taskCount * w / pool->threadCount);
+        int last = (int)((long long)taskCount * (w + 1) / pool->threadCount);
+        atomic_store_explicit(&deque->top, 0, memory_order_relaxed);
+        atomic_store_explicit(&deque->bottom, last - deque->first, memory_order_relaxed);
+    }
+    pool->function = function;
+    pool->data = data;
+    for (int w = 1; w < pool->threadCount; w++) SDL_SignalSemaphore(pool->workers[w].wake);
+    work(pool, 0);
+    for (int w = 1; w < pool->threadCount; w++) SDL_WaitSemaphore(pool->done);
+}
@@ -0,0 +1,53 @@
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <SDL3/SDL.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#define TASK_POOL_MAX_THREADS 64
+
+// Runs task number task of the current batch on worker number worker (0 is the caller).
+typedef void (*TaskFunction)(void* data, int task, int worker);
+
+// One worker's share of a batch, tasks first + [top, bottom). The owner takes tasks from the
+// bottom and idle workers steal from the top, as in a Chase-Lev deque; tasks are never
+// pushed while a batch runs, so the deque is just a range and needs no storage.
+typedef struct {
+    atomic_int top;
+    atomic_int bottom;
+    int first;
+    char padding[64 - 2 * sizeof(atomic_int) - sizeof(int)]; // one deque per cache line
+} TaskDeque;
+
+typedef struct {
+    void* pool;
+    int index;
+    SDL_Thread* thread;
+    SDL_Semaphore* wake; // one per worker, so a fast worker cannot take another's wakeup
+} TaskWorker;
+
+// Fork-join pool for data parallel loops. A batch of tasks is split evenly over the workers'
+// deques up front; a worker that runs out steals from the others, so uneven tasks still
+// keep every thread busy. The calling thread works as worker 0 and returns when the whole
+// batch is done. The other threads sleep on a semaphore between batches.
+typedef struct {
+    int threadCount; // including the caller
+    TaskDeque deques[TASK_POOL_MAX_THREADS];
+    TaskWorker workers[TASK_POOL_MAX_THREADS];
+    SDL_Semaphore* done;
+    TaskFunction function;
+    void* data;
+    bool quit;
+    atomic_int steals; // tasks run by a worker other than their owner, for benchmarks
+} TaskPool;
+
+// threadCount 0 uses one thread per logical core. If threads cannot be created the pool
+// keeps the ones it has, down to running everything on the caller; it never fails.
+void task_pool_init(TaskPool* pool, int threadCount);
+void task_pool_destroy(TaskPool* pool);
+// Calls function for tasks 0 to taskCount - 1, in any order and on any worker, and returns
+// once all of them have finished. Not reentrant: tasks must not call it.
+void task_pool_run(TaskPool* pool, int taskCount, TaskFunction function, void* data);
+
+#endif
@@ -0,0 +1,203 @@
+#include "text_atlas.h"
+#include "gl_util.h"
+#include "mem.h"
+#include <stdio.h>
+#include <string.h>
+
+#define GLYPH_PADDING 1
+
+static const char* textVertexShaderSource = "#version 330 core\n"
+    "layout (location = 0) in vec4 aPosTex;\n"
+    "uniform vec3 camera;\n"
+    "uniform vec2 viewport;\n"
+    "out vec2 TexCoord;\n"
+    "void main() {\n"
+    "   vec2 screen = aPosTex.xy * camera.z - camera.xy;\n"
+    "   gl_Position = vec4(screen.x / viewport.x * 2.0 - 1.0, 1.0 - screen.y / viewport.y * 2.0, 0.0, 1.0);\n"
+    "   TexCoord = aPosTex.zw;\n"
+    "}\n";
+
+static const char* textFragmentShaderSource = "#version 330 core\n"
+    "out vec4 FragColor;\n"
+    "in vec2 TexCoord;\n"
+    "uniform sampler2D atlas;\n"
+    "uniform vec3 color;\n"
+    "void main() {\n"
+    "   FragColor = vec4(color, texture(atlas, TexCoord).r);\n"
+    "}\n";
+
+bool text_atlas_begin(TextAtlas* atlas, int width, int height, float lineHeight) {
+    memset(atlas, 0, sizeof(*atlas));
+    atlas->pixels = mem_calloc((size_t)width * height, 1);
+    if (!atlas->pixels) return false;
+    atlas->width = width;
+    atlas->height = height;
+    atlas->penX = GLYPH_PADDING;
+    atlas->penY = GLYPH_PADDING;
+    atlas->lineHeight = lineHeight;
+    return true;
+}
+
+bool text_atlas_add_glyph(TextAtlas* atlas, int codepoint, const unsigned char* coverage,
+                          int width, int height, int pitch, int pixelStride,
+                          float offsetX, float offsetY, float advance) {
+    if (codepoint < 0 || codepoint >= TEXT_ATLAS_GLYPHS || !atlas->pixels) return false;
+    AtlasGlyph* glyph = &atlas->glyphs[codepoint];
+    glyph->advance = advance;
+    if (!coverage || width <= 0 || height <= 0) return true; // e.g. space: advance only
+
+    // Shelf packing: fill rows left to right, start a new row when the current one is full.
+    if (atlas->penX + width + GLYPH_PADDING > atlas->width) {
+        atlas->penX = GLYPH_PADDING;
+        atlas->penY += atlas->rowHeight + GLYPH_PADDING;
+        atlas->rowHeight = 0;
+    }
+    if (atlas->penY + height + GLYPH_PADDING > atlas->height) {
+        printf("Text atlas full, dropping glyph %d\n", codepoint);
+        return false;
+    }
+
+    for (int row = 0; row < height; row++) {
+        const unsigned char* src = coverage + (size_t)row * pitch;
+        unsigned char* dst = atlas->pixels + (size_t)(atlas->penY + row) * atlas->width + atlas->penX;
+        for (int col = 0; col < width; col++) dst[col] = src[col * pixelStride];
+    }
+
+    glyph->u0 = (float)atlas->penX / atlas->width;
+    glyph->v0 = (float)atlas->penY / atlas->height;
+    glyph->u1 = (float)(atlas->penX + width) / atlas->width;
+    glyph->v1 = (float)(atlas->penY + height) / atlas->height;
+    glyph->width = (float)width;
+    glyph->height = (float)height;
+    glyph->offsetX = offsetX;
+    glyph->offsetY = offsetY;
+    glyph->hasBitmap = true;
+
+    atlas->penX += width + GLYPH_PADDING;
+    if (height > atlas->rowHeight) atlas->rowHeight = height;
+    return true;
+}
+
+void text_atlas_end(TextAtlas* atlas) {
+    glGenTextures(1, &atlas->texture);
+    glBindTexture(GL_TEXTURE_2D, atlas->texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, atlas->width, atlas->height, 0, GL_RED, GL_UNSIGNED_BYTE, atlas->pixels);
+    renderStats.textureUploads++;
+    renderStats.uploadBytes += (long long)atlas->width * atlas->height;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    mem_free(atlas->pixels);
+    atlas->pixels = NULL;
+}
+
+void text_atlas_destroy(TextAtlas* atlas) {
+    mem_free(atlas->pixels);
+    if (atlas->texture) glDeleteTextures(1, &atlas->texture);
+    memset(atlas, 0, sizeof(*atlas));
+}
+
+float text_atlas_measure(const TextAtlas* atlas, const char* text, float scale) {
+    float width = 0.0f;
+    for (const char* c = text; *c; c++) {
+        unsigned char ch = (unsigned char)*c;
+        if (ch < TEXT_ATLAS_GLYPHS) width += atlas->glyphs[ch].advance * scale;
+    }
+    return width;
+}
+
+bool text_batch_init(TextBatch* batch) {
+    memset(batch, 0, sizeof(*batch));
+    batch->program = gl_create_program(textVertexShaderSource, textFragmentShaderSource);
+    if (!batch->program) return false;
+    batch->cameraLoc = glGetUniformLocation(batch->program, "camera");
+    batch->viewportLoc = glGetUniformLocation(batch->program, "viewport");
+    batch->colorLoc = glGetUniformLocation(batch->program, "color");
+    batch->atlasLoc = glGetUniformLocation(batch->program, "atlas");
+
+    // The vertices are pointed into the vertex stream when drawing.
+    glGenVertexArrays(1, &batch->vao);
+    glBindVertexArray(batch->vao);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+    return true;
+}
+
+void text_batch_destroy(TextBatch* batch) {
+    mem_free(batch->vertices);
+    glDeleteVertexArrays(1, &batch->vao);
+    glDeleteProgram(batch->program);
+    memset(batch, 0, sizeof(*batch));
+}
+
+void text_batch_begin(TextBatch* batch) {
+    batch->vertexCount = 0;
+}
+
+void text_batch_add(TextBatch* batch, const TextAtlas* atlas, const char* text, float x, float y, float scale) {
+    int needed = batch->vertexCount + (int)strlen(text) * 6;
+    if (needed > batch->vertexCapacity) {
+        int newCapacity = batch->vertexCapacity ? batch->vertexCapacity : 1536;
+        while (newCapacity < needed) newCapacity *= 2;
+        float* grown = mem_realloc(batch->vertices, (size_t)newCapacity * 4 * sizeof(float));
+        if (!grown) {
+            printf("Failed to grow text batch to %d vertices\n", newCapacity);
+            return;
+        }
+        batch->vertices = grown;
+        batch->vertexCapacity = newCapacity;
+    }
+
+    float* v = &batch->vertices[batch->vertexCount * 4];
+    for (const char* c = text; *c; c++) {
+        unsigned char ch = (unsigned char)*c;
+        if (ch >= TEXT_ATLAS_GLYPHS) continue;
+        const AtlasGlyph* glyph = &atlas->glyphs[ch];
+        if (glyph->hasBitmap) {
+            float x0 = x + glyph->offsetX * scale;
+            float y0 = y + glyph->offsetY * scale;
+            float x1 = x0 + glyph->width * scale;
+            float y1 = y0 + glyph->height * scale;
+            float quad[6][4] = {
+                {x0, y0, glyph->u0, glyph->v0},
+                {x0, y1, glyph->u0, glyph->v1},
+                {x1, y1, glyph->u1, glyph->v1},
+                {x1, y1, glyph->u1, glyph->v1},
+                {x1, y0, glyph->u1, glyph->v0},
+                {x0, y0, glyph->u0, glyph->v0}
+            };
+            memcpy(v, quad, sizeof(quad));
+            v += 24;
+            batch->vertexCount += 6;
+        }
+        x += glyph->advance * scale;
+    }
+}
+
+void text_batch_draw(TextBatch* batch, StreamBuffer* stream, const TextAtlas* atlas, const Camera* camera,
+                     float viewWidth, float viewHeight, float r, float g, float b) {
+    if (batch->vertexCount == 0) return;
+    size_t bytes = (size_t)batch->vertexCount * 4 * sizeof(float);
+    GLintptr offset;
+    float* vertices = stream_buffer_map(stream, bytes, &offset);
+    if (!vertices) return;
+    memcpy(vertices, batch->vertices, bytes);
+    stream_buffer_unmap(stream);
+
+    glUseProgram(batch->program);
+    glUniform3f(batch->cameraLoc, camera->x, camera->y, camera->scale);
+    glUniform2f(batch->viewportLoc, viewWidth, viewHeight);
+    glUniform3f(batch->colorLoc, r, g, b);
+    glUniform1i(batch->atlasLoc, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, atlas->texture);
+    glBindVertexArray(batch->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, stream->buffer);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)offset);
+    glDrawArrays(GL_TRIANGLES, 0, batch->vertexCount);
+    renderStats.drawCalls++;
+    glBindVertexArray(0);
+}
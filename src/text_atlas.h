@@ -0,0 +1,60 @@
+#ifndef TEXT_ATLAS_H
+#define TEXT_ATLAS_H
+
+#include <glad/gl.h>
+#include <stdbool.h>
+#include "camera.h"
+#include "stream_buffer.h"
+
+#define TEXT_ATLAS_GLYPHS 128
+
+typedef struct {
+    float u0, v0, u1, v1;
+    float width, height;     // quad size in pixels
+    float offsetX, offsetY;  // from the pen position to the top-left of the quad
+    float advance;
+    bool hasBitmap;
+} AtlasGlyph;
+
+// All glyphs of one font size packed into a single GL_R8 texture. Glyphs are added once
+// between text_atlas_begin and text_atlas_end; the texture is uploaded once at the end.
+typedef struct {
+    GLuint texture;
+    int width, height;
+    unsigned char* pixels; // coverage while building, freed after upload
+    int penX, penY, rowHeight;
+    float lineHeight;
+    AtlasGlyph glyphs[TEXT_ATLAS_GLYPHS];
+} TextAtlas;
+
+// Text quads for many strings, drawn with a single call against one atlas.
+typedef struct {
+    GLuint program;
+    GLuint vao;
+    GLint cameraLoc, viewportLoc, colorLoc, atlasLoc;
+    float* vertices; // x, y, u, v; six vertices per glyph
+    int vertexCount;
+    int vertexCapacity;
+} TextBatch;
+
+bool text_atlas_begin(TextAtlas* atlas, int width, int height, float lineHeight);
+// coverage points at the coverage byte of the first pixel; pixelStride is the distance
+// between pixels in bytes, so both 8-bit bitmaps and the alpha channel of RGBA surfaces work.
+bool text_atlas_add_glyph(TextAtlas* atlas, int codepoint, const unsigned char* coverage,
+                          int width, int height, int pitch, int pixelStride,
+                          float offsetX, float offsetY, float advance);
+void text_atlas_end(TextAtlas* atlas);
+void text_atlas_destroy(TextAtlas* atlas);
+float text_atlas_measure(const TextAtlas* atlas, const char* text, float scale);
+
+bool text_batch_init(TextBatch* batch);
+void text_batch_destroy(TextBatch* batch);
+void text_batch_begin(TextBatch* batch);
+// Lays text out starting at the pen position (x, y); units are those of the camera used to draw.
+void text_batch_add(TextBatch* batch, const TextAtlas* atlas, const char* text, float x, float y, float scale);
+// Copies the vertices into the vertex stream and draws them. The vertices are kept, so text
+// that does not change can be drawn again next frame without laying it out.
+void text_batch_draw(TextBatch* batch, StreamBuffer* stream, const TextAtlas* atlas, const Camera* camera,
+                     float viewWidth, float viewHeight, float r, float g, float b);
+
+#endif
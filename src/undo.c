@@ -0,0 +1,251 @@
+#include "undo.h"
+#include "mem.h"
+#include <stdio.h>
+#include <string.h>
+
+// Item layout: size byte, op byte, node index, the op's fields, size byte again. The size at
+// both ends lets replay walk items in either direction. Entries are framed the same way with
+// a 32-bit size before and after their items.
+#define ITEM_MAX_SIZE 64
+#define ENTRY_FRAME_SIZE 4
+#define NO_ITEM UINT64_MAX
+
+static void ring_write(UndoJournal* journal, uint64_t pos, const void* source, size_t size) {
+    size_t offset = (size_t)(pos % journal->capacity);
+    size_t first = journal->capacity - offset < size ? journal->capacity - offset : size;
+    memcpy(journal->data + offset, source, first);
+    memcpy(journal->data, (const unsigned char*)source + first, size - first);
+}
+
+static void ring_read(const UndoJournal* journal, uint64_t pos, void* destination, size_t size) {
+    size_t offset = (size_t)(pos % journal->capacity);
+    size_t first = journal->capacity - offset < size ? journal->capacity - offset : size;
+    memcpy(destination, journal->data + offset, first);
+    memcpy((unsigned char*)destination + first, journal->data, size - first);
+}
+
+static unsigned char ring_byte(const UndoJournal* journal, uint64_t pos) {
+    return journal->data[pos % journal->capacity];
+}
+
+bool undo_init(UndoJournal* journal, size_t capacity) {
+    memset(journal, 0, sizeof(*journal));
+    journal->lastItem = NO_ITEM;
+    if (capacity < 4 * ITEM_MAX_SIZE) capacity = 4 * ITEM_MAX_SIZE;
+    journal->data = mem_alloc(capacity);
+    if (!journal->data) {
+        printf("Failed to allocate %zu bytes of undo history\n", capacity);
+        return false;
+    }
+    journal->capacity = capacity;
+    return true;
+}
+
+void undo_destroy(UndoJournal* journal) {
+    mem_free(journal->data);
+    memset(journal, 0, sizeof(*journal));
+}
+
+static void reset(UndoJournal* journal) {
+    journal->head = journal->cursor = journal->end = journal->entryStart = 0;
+    journal->lastItem = NO_ITEM;
+}
+
+void undo_clear(UndoJournal* journal) {
+    reset(journal);
+    // The open entry restarts empty; its earlier items described the old graph.
+    if (journal->depth > 0) {
+        journal->overflow = false;
+        journal->end = ENTRY_FRAME_SIZE;
+    }
+}
+
+// Drops the oldest entries until size more bytes fit. Fails once only the open entry is left.
+static bool make_room(UndoJournal* journal, size_t size) {
+    while (journal->end + size - journal->head > journal->capacity) {
+        if (journal->head >= journal->entryStart) return false;
+        uint32_t entrySize;
+        ring_read(journal, journal->head, &entrySize, sizeof(entrySize));
+        journal->head += entrySize;
+    }
+    return true;
+}
+
+void undo_begin(UndoJournal* journal) {
+    if (journal->depth++ > 0) return;
+    // A new edit ends the redo branch.
+    journal->end = journal->cursor;
+    journal->entryStart = journal->cursor;
+    journal->lastItem = NO_ITEM;
+    journal->overflow = !make_room(journal, ENTRY_FRAME_SIZE);
+    journal->end += ENTRY_FRAME_SIZE; // the size is written when the entry ends
+}
+
+void undo_end(UndoJournal* journal) {
+    if (journal->depth == 0 || --journal->depth > 0) return;
+    journal->lastItem = NO_ITEM;
+    if (journal->end == journal->entryStart + ENTRY_FRAME_SIZE) {
+        journal->end = journal->entryStart; // nothing happened
+        return;
+    }
+    if (journal->overflow || !make_room(journal, ENTRY_FRAME_SIZE)) {
+        // The older entries were already dropped to make room, and without this one the
+        // rest of the history no longer leads to the current graph.
+        printf("Undo: change larger than the %zu byte history, history cleared\n", journal->capacity);
+        journal->overflow = false;
+        reset(journal);
+        return;
+    }
+    uint32_t entrySize = (uint32_t)(journal->end + ENTRY_FRAME_SIZE - journal->entryStart);
+    ring_write(journal, journal->entryStart, &entrySize, sizeof(entrySize));
+    ring_write(journal, journal->end, &entrySize, sizeof(entrySize));
+    journal->end += ENTRY_FRAME_SIZE;
+    journal->cursor = journal->end;
+}
+
+static size_t put(unsigned char* out, size_t at, const void* value, size_t size) {
+    memcpy(out + at, value, size);
+    return at + size;
+}
+
+void undo_record(UndoJournal* journal, const UndoItem* item) {
+    if (journal->depth == 0 || journal->overflow) return;
+
+    if (item->op == UNDO_MOVE && journal->lastItem != NO_ITEM) {
+        unsigned char head[2];
+        int node;
+        ring_read(journal, journal->lastItem, head, sizeof(head));
+        ring_read(journal, journal->lastItem + 2, &node, sizeof(node));
+        if (head[1] == UNDO_MOVE && node == item->node) {
+            float to[2] = {item->toX, item->toY};
+            ring_write(journal, journal->lastItem + 2 + sizeof(int) + 2 * sizeof(float), to, sizeof(to));
+            return;
+        }
+    }
+
+    unsigned char encoded[ITEM_MAX_SIZE];
+    size_t size = 2;
+    size = put(encoded, size, &item->node, sizeof(item->node));
+    switch (item->op) {
+    case UNDO_MOVE: {
+        float values[4] = {item->x, item->y, item->toX, item->toY};
+        size = put(encoded, size, values, sizeof(values));
+        break;
+    }
+    case UNDO_SET_VALUE: {
+        float values[2] = {item->value, item->toValue};
+        size = put(encoded, size, values, sizeof(values));
+        break;
+    }
+    case UNDO_ADD_NODE:
+    case UNDO_REMOVE_NODE: {
+        float values[5] = {item->x, item->y, item->width, item->height, item->value};
+        unsigned char type = (unsigned char)item->type;
+        const char* nameEnd = memchr(item->name, '\0', sizeof(item->name) - 1);
+        unsigned char nameLength = (unsigned char)(nameEnd ? nameEnd - item->name : (long)sizeof(item->name) - 1);
+        size = put(encoded, size, values, sizeof(values));
+        size = put(encoded, size, &type, 1);
+        size = put(encoded, size, &nameLength, 1);
+        size = put(encoded, size, item->name, nameLength);
+        break;
+    }
+    case UNDO_CONNECT:
+    case UNDO_DISCONNECT: {
+        unsigned char toSlot = (unsigned char)item->toSlot;
+        size = put(encoded, size, &item->toNode, sizeof(item->toNode));
+        size = put(encoded, size, &toSlot, 1);
+        break;
+    }
+    }
+    encoded[0] = (unsigned char)(size + 1);
+    encoded[1] = (unsigned char)item->op;
+    encoded[size] = (unsigned char)(size + 1);
+    size++;
+
+    if (!make_room(journal, size)) {
+        journal->overflow = true;
+        return;
+    }
+    ring_write(journal, journal->end, encoded, size);
+    journal->lastItem = journal->end;
+    journal->end += size;
+}
+
+bool undo_step_back(UndoJournal* journal, UndoReplay* replay) {
+    if (!undo_can_undo(journal)) return false;
+    uint32_t entrySize;
+    ring_read(journal, journal->cursor - ENTRY_FRAME_SIZE, &entrySize, sizeof(entrySize));
+    replay->pos = journal->cursor - ENTRY_FRAME_SIZE;
+    replay->stop = journal->cursor - entrySize + ENTRY_FRAME_SIZE;
+    replay->backward = true;
+    journal->cursor -= entrySize;
+    return true;
+}
+
+bool undo_step_forward(UndoJournal* journal, UndoReplay* replay) {
+    if (!undo_can_redo(journal)) return false;
+    uint32_t entrySize;
+    ring_read(journal, journal->cursor, &entrySize, sizeof(entrySize));
+    replay->pos = journal->cursor + ENTRY_FRAME_SIZE;
+    replay->stop = journal->cursor + entrySize - ENTRY_FRAME_SIZE;
+    replay->backward = false;
+    journal->cursor += entrySize;
+    return true;
+}
+
+bool undo_next_item(const UndoJournal* journal, UndoReplay* replay, UndoItem* item) {
+    if (replay->pos == replay->stop) return false;
+    uint64_t start;
+    if (replay->backward) {
+        start = replay->pos - ring_byte(journal, replay->pos - 1);
+        replay->pos = start;
+    } else {
+        start = replay->pos;
+        replay->pos += ring_byte(journal, replay->pos);
+    }
+
+    unsigned char encoded[ITEM_MAX_SIZE];
+    ring_read(journal, start, encoded, ring_byte(journal, start));
+    memset(item, 0, sizeof(*item));
+    item->op = (UndoOp)encoded[1];
+    memcpy(&item->node, encoded + 2, sizeof(item->node));
+    const unsigned char* fields = encoded + 2 + sizeof(item->node);
+    switch (item->op) {
+    case UNDO_MOVE: {
+        float values[4];
+        memcpy(values, fields, sizeof(values));
+        item->x = values[0];
+        item->y = values[1];
+        item->toX = values[2];
+        item->toY = values[3];
+        break;
+    }
+    case UNDO_SET_VALUE: {
+        float values[2];
+        memcpy(values, fields, sizeof(values));
+        item->value = values[0];
+        item->toValue = values[1];
+        break;
+    }
+    case UNDO_ADD_NODE:
+    case UNDO_REMOVE_NODE: {
+        float values[5];
+        memcpy(values, fields, sizeof(values));
+        item->x = values[0];
+        item->y = values[1];
+        item->width = values[2];
+        item->height = values[3];
+        item->value = values[4];
+        item->type = (NodeType)fields[sizeof(values)];
+        unsigned char nameLength = fields[sizeof(values) + 1];
+        memcpy(item->name, fields + sizeof(values) + 2, nameLength);
+        break;
+    }
+    case UNDO_CONNECT:
+    case UNDO_DISCONNECT:
+        memcpy(&item->toNode, fields, sizeof(item->toNode));
+        item->toSlot = fields[sizeof(item->toNode)];
+        break;
+    }
+    return true;
+}
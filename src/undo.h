@@ -0,0 +1,84 @@
+#ifndef UNDO_H
+#define UNDO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "node2d.h"
+
+// Primitive edits. An entry is a sequence of them; undo applies their inverses newest first,
+// redo replays them oldest first.
+typedef enum {
+    UNDO_ADD_NODE,
+    UNDO_REMOVE_NODE,
+    UNDO_CONNECT,
+    UNDO_DISCONNECT,
+    UNDO_MOVE,
+    UNDO_SET_VALUE
+} UndoOp;
+
+// One edit, decoded. Nodes are referred to by slot index: replaying the journal in order
+// frees and reuses the same slots as the original edits did.
+typedef struct {
+    UndoOp op;
+    int node;       // slot index; the from node of a connection
+    int toNode;     // connections only
+    int toSlot;
+    float x, y;     // the node's position, before the move for UNDO_MOVE
+    float toX, toY; // UNDO_MOVE only
+    float width, height;
+    NodeType type;
+    float value;    // before the change for UNDO_SET_VALUE
+    float toValue;  // UNDO_SET_VALUE only
+    char name[32];  // as in Node2D
+} UndoItem;
+
+// Undo history as variable-length entries in a fixed-size byte ring. Items are stored packed,
+// 12 bytes for a connection and 23 for a move, and the oldest entries are dropped when the
+// ring is full, so memory stays at the capacity given to undo_init. Positions are logical
+// byte offsets that only grow; the ring index is the position modulo the capacity.
+//     head <= cursor <= end: entries in [head, cursor) can be undone, [cursor, end) redone.
+typedef struct {
+    unsigned char* data;
+    size_t capacity;
+    uint64_t head;
+    uint64_t cursor;
+    uint64_t end;
+    uint64_t entryStart; // the entry being recorded
+    uint64_t lastItem;   // its last item, so consecutive moves of a node merge; UINT64_MAX if none
+    int depth;           // undo_begin nesting
+    bool overflow;       // the open entry outgrew the ring and will be dropped
+} UndoJournal;
+
+bool undo_init(UndoJournal* journal, size_t capacity);
+void undo_destroy(UndoJournal* journal);
+// Forgets all history, e.g. after the graph was replaced. An open entry stays open.
+void undo_clear(UndoJournal* journal);
+
+// Edits recorded between the outermost begin and end form one entry. Beginning an entry
+// discards whatever could be redone. Nothing is recorded outside an entry, so graphs built
+// by code do not fill the history.
+void undo_begin(UndoJournal* journal);
+void undo_end(UndoJournal* journal);
+// Appends an edit to the open entry. A move of the same node as the previous item only
+// updates that item's destination, so a drag becomes one move however many events it took.
+void undo_record(UndoJournal* journal, const UndoItem* item);
+
+static inline bool undo_recording(const UndoJournal* journal) { return journal->depth > 0; }
+static inline bool undo_can_undo(const UndoJournal* journal) { return journal->depth == 0 && journal->cursor > journal->head; }
+static inline bool undo_can_redo(const UndoJournal* journal) { return journal->depth == 0 && journal->end > journal->cursor; }
+static inline size_t undo_bytes_used(const UndoJournal* journal) { return (size_t)(journal->end - journal->head); }
+
+// Walks the items of one entry. undo_step_back moves the cursor before the newest applied
+// entry and yields its items newest first; undo_step_forward moves it past the next entry
+// and yields its items oldest first. Both return false if there is no such entry.
+typedef struct {
+    uint64_t pos, stop;
+    bool backward;
+} UndoReplay;
+
+bool undo_step_back(UndoJournal* journal, UndoReplay* replay);
+bool undo_step_forward(UndoJournal* journal, UndoReplay* replay);
+bool undo_next_item(const UndoJournal* journal, UndoReplay* replay, UndoItem* item);
+
+#endif
@@ -0,0 +1,203 @@
+#include "wire_batch.h"
+#include "gl_util.h"
+#include "node2d.h"
+#include "mem.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* wireVertexShaderSource = "#version 330 core\n"
+    "layout (location = 0) in vec4 aEndpoints;\n"
+    "uniform vec3 camera;\n"
+    "uniform vec2 viewport;\n"
+    "uniform int segments;\n"
+    "uniform float handleMin;\n"
+    "uniform float minLength;\n"
+    "void main() {\n"
+    "   vec2 p0 = aEndpoints.xy;\n"
+    "   vec2 p3 = aEndpoints.zw;\n"
+    "   float h = max(abs(p3.x - p0.x) * 0.5, handleMin);\n"
+    "   vec2 p1 = p0 + vec2(h, 0.0);\n"
+    "   vec2 p2 = p3 - vec2(h, 0.0);\n"
+    "   float t = float(gl_VertexID) / float(segments);\n"
+    "   float u = 1.0 - t;\n"
+    "   vec2 p = u * u * u * p0 + 3.0 * u * u * t * p1 + 3.0 * u * t * t * p2 + t * t * t * p3;\n"
+    "   vec2 screen = p * camera.z - camera.xy;\n"
+    "   if (length(p3 - p0) * camera.z < minLength) {\n"
+    "       gl_Position = vec4(2.0, 2.0, 0.0, 1.0);\n" // outside the clip volume, so the strip is dropped
+    "       return;\n"
+    "   }\n"
+    "   gl_Position = vec4(screen.x / viewport.x * 2.0 - 1.0, 1.0 - screen.y / viewport.y * 2.0, 0.0, 1.0);\n"
+    "}\n";
+
+static const char* wireFragmentShaderSource = "#version 330 core\n"
+    "out vec4 FragColor;\n"
+    "uniform vec3 color;\n"
+    "void main() {\n"
+    "   FragColor = vec4(color, 1.0);\n"
+    "}\n";
+
+#define EDGE_BYTES (4 * sizeof(float))
+
+static bool reserve(WireBatch* batch, int count) {
+    if (count <= batch->capacity) return true;
+    int newCapacity = batch->capacity ? batch->capacity : 256;
+    while (newCapacity < count) newCapacity *= 2;
+    float* endpoints = mem_realloc(batch->endpoints, newCapacity * EDGE_BYTES);
+    if (!endpoints) return false;
+    batch->endpoints = endpoints;
+    int* dirtyEdges = mem_realloc(batch->dirtyEdges, newCapacity * sizeof(int));
+    if (!dirtyEdges) return false;
+    batch->dirtyEdges = dirtyEdges;
+    unsigned char* dirtyFlags = mem_realloc(batch->dirtyFlags, newCapacity);
+    if (!dirtyFlags) return false;
+    memset(dirtyFlags + batch->capacity, 0, newCapacity - batch->capacity);
+    batch->dirtyFlags = dirtyFlags;
+    batch->capacity = newCapacity;
+    return true;
+}
+
+bool wire_batch_init(WireBatch* batch) {
+    memset(batch, 0, sizeof(*batch));
+    batch->program = gl_create_program(wireVertexShaderSource, wireFragmentShaderSource);
+    if (!batch->program) return false;
+    batch->cameraLoc = glGetUniformLocation(batch->program, "camera");
+    batch->viewportLoc = glGetUniformLocation(batch->program, "viewport");
+    batch->colorLoc = glGetUniformLocation(batch->program, "color");
+    batch->segmentsLoc = glGetUniformLocation(batch->program, "segments");
+    batch->minLengthLoc = glGetUniformLocation(batch->program, "minLength");
+    glUseProgram(batch->program);
+    glUniform1f(glGetUniformLocation(batch->program, "handleMin"), WIRE_HANDLE_MIN);
+    glUseProgram(0);
+
+    glGenVertexArrays(1, &batch->vao);
+    glGenBuffers(1, &batch->vbo);
+    glBindVertexArray(batch->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, batch->vbo);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, (GLsizei)EDGE_BYTES, (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribDivisor(0, 1);
+    glBindVertexArray(0);
+    return true;
+}
+
+void wire_batch_destroy(WireBatch* batch) {
+    mem_free(batch->endpoints);
+    mem_free(batch->dirtyEdges);
+    mem_free(batch->dirtyFlags);
+    glDeleteBuffers(1, &batch->vbo);
+    glDeleteVertexArrays(1, &batch->vao);
+    glDeleteProgram(batch->program);
+    memset(batch, 0, sizeof(*batch));
+}
+
+void wire_batch_set(WireBatch* batch, int index, float x1, float y1, float x2, float y2) {
+    if (index >= batch->count) {
+        if (!reserve(batch, index + 1)) {
+            printf("Failed to grow wire batch to %d edges\n", index + 1);
+            return;
+        }
+        batch->count = index + 1;
+    }
+    float* e = &batch->endpoints[index * 4];
+    e[0] = x1;
+    e[1] = y1;
+    e[2] = x2;
+    e[3] = y2;
+    if (!batch->dirtyFlags[index]) {
+        batch->dirtyFlags[index] = 1;
+        batch->dirtyEdges[batch->dirtyCount++] = index;
+    }
+}
+
+void wire_batch_truncate(WireBatch* batch, int count) {
+    if (count < batch->count) batch->count = count;
+}
+
+void wire_batch_set_preview(WireBatch* batch, bool active, float x1, float y1, float x2, float y2) {
+    batch->previewActive = active;
+    batch->preview[0] = x1;
+    batch->preview[1] = y1;
+    batch->preview[2] = x2;
+    batch->preview[3] = y2;
+}
+
+int wire_segments_for_zoom(float scale) {
+    if (lod_level(scale) == LOD_CLUSTERS) return 1;
+    int segments = (int)(WIRE_SEGMENTS_PER_ZOOM * scale + 0.5f);
+    if (segments < WIRE_SEGMENTS_MIN) return WIRE_SEGMENTS_MIN;
+    if (segments > WIRE_SEGMENTS_MAX) return WIRE_SEGMENTS_MAX;
+    return segments;
+}
+
+void wire_batch_upload(WireBatch* batch) {
+    glBindBuffer(GL_ARRAY_BUFFER, batch->vbo);
+    if (batch->count > batch->gpuCapacity) {
+        int newCapacity = batch->gpuCapacity ? batch->gpuCapacity : 256;
+        while (newCapacity < batch->count) newCapacity *= 2;
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)newCapacity * EDGE_BYTES, NULL, GL_DYNAMIC_DRAW);
+        batch->gpuCapacity = newCapacity;
+        batch->reallocated = true;
+    }
+
+    if (batch->reallocated) {
+        if (batch->count > 0) {
+            glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)batch->count * EDGE_BYTES, batch->endpoints);
+            renderStats.uploadBytes += (long long)batch->count * EDGE_BYTES;
+        }
+        batch->reallocated = false;
+    } else if (batch->dirtyCount <= WIRE_MAX_SUBUPLOADS) {
+        for (int i = 0; i < batch->dirtyCount; i++) {
+            int edge = batch->dirtyEdges[i];
+            if (edge >= batch->count) continue;
+            glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)edge * EDGE_BYTES, EDGE_BYTES, &batch->endpoints[edge * 4]);
+            renderStats.uploadBytes += EDGE_BYTES;
+        }
+    } else {
+        int first = batch->count, last = -1;
+        for (int i = 0; i < batch->dirtyCount; i++) {
+            int edge = batch->dirtyEdges[i];
+            if (edge >= batch->count) continue;
+            if (edge < first) first = edge;
+            if (edge > last) last = edge;
+        }
+        if (last >= first) {
+            glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)first * EDGE_BYTES, (GLsizeiptr)(last - first + 1) * EDGE_BYTES,
+                            &batch->endpoints[first * 4]);
+            renderStats.uploadBytes += (long long)(last - first + 1) * EDGE_BYTES;
+        }
+    }
+    for (int i = 0; i < batch->dirtyCount; i++) batch->dirtyFlags[batch->dirtyEdges[i]] = 0;
+    batch->dirtyCount = 0;
+}
+
+void wire_batch_draw(WireBatch* batch, StreamBuffer* stream, const Camera* camera, float viewWidth, float viewHeight) {
+    if (batch->count == 0 && !batch->previewActive) return;
+    glUseProgram(batch->program);
+    glUniform3f(batch->cameraLoc, camera->x, camera->y, camera->scale);
+    glUniform2f(batch->viewportLoc, viewWidth, viewHeight);
+    glUniform3f(batch->colorLoc, 1.0f, 1.0f, 1.0f);
+    int segments = wire_segments_for_zoom(camera->scale);
+    glUniform1i(batch->segmentsLoc, segments);
+    // Zoomed out to clusters, wires shorter than an impostor would only paint over it.
+    glUniform1f(batch->minLengthLoc, lod_level(camera->scale) == LOD_CLUSTERS ? LOD_CLUSTER_PIXELS : 0.0f);
+    glBindVertexArray(batch->vao);
+    // One line strip per edge; the vertex shader places vertex i at t = i / segments.
+    if (batch->count > 0) {
+        glDrawArraysInstanced(GL_LINE_STRIP, 0, segments + 1, batch->count);
+        renderStats.drawCalls++;
+    }
+    GLintptr offset;
+    float* preview = batch->previewActive ? stream_buffer_map(stream, EDGE_BYTES, &offset) : NULL;
+    if (preview) {
+        memcpy(preview, batch->preview, EDGE_BYTES);
+        stream_buffer_unmap(stream);
+        glBindBuffer(GL_ARRAY_BUFFER, stream->buffer);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, (GLsizei)EDGE_BYTES, (void*)offset);
+        glDrawArraysInstanced(GL_LINE_STRIP, 0, segments + 1, 1);
+        renderStats.drawCalls++;
+        glBindBuffer(GL_ARRAY_BUFFER, batch->vbo);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, (GLsizei)EDGE_BYTES, (void*)0);
+    }
+    glBindVertexArray(0);
+}
@@ -0,0 +1,49 @@
+#ifndef WIRE_BATCH_H
+#define WIRE_BATCH_H
+
+#include <glad/gl.h>
+#include <stdbool.h>
+#include "camera.h"
+#include "stream_buffer.h"
+
+// Edges dirtied in one frame up to this count are uploaded one by one, beyond it as a single range.
+#define WIRE_MAX_SUBUPLOADS 32
+
+// Connection endpoints in world space, kept in a vertex buffer of their own and drawn with one call.
+// Edge i of the batch mirrors connections[i]; only edges that changed are uploaded again. The
+// preview wire changes every frame, so it goes through the vertex stream and is drawn on its own.
+// The endpoints are per-instance data: the vertex shader expands each edge into the Bezier of
+// wire_point() in node2d.h, so moving a node re-sends 16 bytes per attached edge and no curve is
+// tessellated on the CPU.
+typedef struct {
+    GLuint program;
+    GLuint vao, vbo;
+    GLint cameraLoc, viewportLoc, colorLoc, segmentsLoc, minLengthLoc;
+    float* endpoints; // 4 floats per edge: from x, y, to x, y
+    int count;
+    int capacity;
+    int gpuCapacity; // edges the vertex buffer can hold
+    bool reallocated; // buffer storage was recreated and needs a full upload
+    int* dirtyEdges;
+    unsigned char* dirtyFlags;
+    int dirtyCount;
+    bool previewActive;
+    float preview[4];
+} WireBatch;
+
+bool wire_batch_init(WireBatch* batch);
+void wire_batch_destroy(WireBatch* batch);
+
+// Writes the endpoints of edge index. index may be equal to count to append an edge.
+void wire_batch_set(WireBatch* batch, int index, float x1, float y1, float x2, float y2);
+// Drops the edges at and after count.
+void wire_batch_truncate(WireBatch* batch, int count);
+// The preview wire shown while a connection is being dragged out of a slot.
+void wire_batch_set_preview(WireBatch* batch, bool active, float x1, float y1, float x2, float y2);
+void wire_batch_upload(WireBatch* batch);
+// Line segments per curve at a camera scale; more when zoomed in, where the curve is larger,
+// and straight chords once nodes are drawn as clusters.
+int wire_segments_for_zoom(float scale);
+void wire_batch_draw(WireBatch* batch, StreamBuffer* stream, const Camera* camera, float viewWidth, float viewHeight);
+
+#endif